@@ -0,0 +1,90 @@
+// Read throughput of DictionaryDB::get_meaning against thread count, with
+// every read on the single write connection versus a read pool with one
+// connection per thread. The definition cache is disabled so every lookup
+// reaches SQLite.
+//
+//   make db_pool_bench && ./db_pool_bench [rows] [seconds-per-run]
+#include "../include/database.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* BENCH_DB = "/tmp/db_pool_bench.db";
+
+std::string word_for(size_t i) {
+    return "word" + std::to_string(i);
+}
+
+void fill(size_t rows) {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(std::string(BENCH_DB) + suffix);
+    }
+    DictionaryDB db(BENCH_DB);
+    std::vector<std::pair<std::string, std::string>> batch;
+    for (size_t i = 0; i < rows; ++i) {
+        batch.emplace_back(word_for(i), "a synthetic definition for entry number " + std::to_string(i));
+        if (batch.size() == 50000 || i + 1 == rows) {
+            db.add_words(batch);
+            batch.clear();
+        }
+    }
+}
+
+double run(size_t threads, size_t read_connections, size_t rows, double seconds) {
+    DictionaryDBOptions options;
+    options.read_connections = read_connections;
+    options.cache.max_bytes = 0;
+    DictionaryDB db(BENCH_DB, options);
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            std::uniform_int_distribution<size_t> pick(0, rows - 1);
+            size_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (db.get_meaning(word_for(pick(rng))).empty()) {
+                    std::cerr << "missing row" << std::endl;
+                }
+                ++done;
+            }
+            total += done;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return total / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    double seconds = argc > 2 ? std::stod(argv[2]) : 2.0;
+
+    std::cout << "Filling " << rows << " rows..." << std::endl;
+    fill(rows);
+
+    std::printf("%8s %18s %18s %8s\n", "threads", "single (lookups/s)", "pool (lookups/s)", "speedup");
+    size_t max_threads = std::max(8u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double single = run(threads, 0, rows, seconds);
+        double pooled = run(threads, threads, rows, seconds);
+        std::printf("%8zu %18.0f %18.0f %7.2fx\n", threads, single, pooled, pooled / single);
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+// Load generator for radix_dictd. Each connection runs on its own thread and
+// keeps `depth` requests pipelined; every response's round trip is timed.
+//
+//   ./dictd_loadgen [--port N | --unix PATH] [--connections N] [--depth N]
+//                   [--seconds S] [--words FILE] [--mix search,prefix,top]
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 7878;
+    std::string unix_path;
+    int connections = 4;
+    int depth = 16;
+    double seconds = 5;
+    std::string words_file = "assets/dictionary.txt";
+    std::vector<std::string> mix = {"search", "search", "search", "prefix", "top"};
+};
+
+struct ThreadResult {
+    std::vector<double> latencies_us;
+    size_t errors = 0;
+    bool failed = false;
+};
+
+int connect_to(const Options& options) {
+    if (!options.unix_path.empty()) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, options.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Parses complete responses from `buf` starting at `pos`; returns how many
+// were consumed and counts ERR replies
+size_t take_responses(const std::string& buf, size_t& pos, size_t& errors) {
+    size_t complete = 0;
+    while (true) {
+        size_t eol = buf.find('\n', pos);
+        if (eol == std::string::npos) {
+            return complete;
+        }
+        size_t lines = 0;
+        if (buf.compare(pos, 3, "OK ") == 0) {
+            lines = std::strtoul(buf.c_str() + pos + 3, nullptr, 10);
+        } else {
+            ++errors;
+        }
+        size_t end = eol;
+        for (size_t i = 0; i < lines; ++i) {
+            end = buf.find('\n', end + 1);
+            if (end == std::string::npos) {
+                return complete;
+            }
+        }
+        pos = end + 1;
+        ++complete;
+    }
+}
+
+void run_connection(const Options& options, const std::vector<std::string>& words, unsigned seed,
+                    Clock::time_point stop_at, ThreadResult& result) {
+    int fd = connect_to(options);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick_word(0, words.size() - 1);
+    std::uniform_int_distribution<size_t> pick_op(0, options.mix.size() - 1);
+
+    auto make_request = [&](std::string& out) {
+        const std::string& op = options.mix[pick_op(rng)];
+        const std::string& word = words[pick_word(rng)];
+        if (op == "prefix") {
+            out += "prefix " + word.substr(0, std::min<size_t>(2, word.size())) + " 20\n";
+        } else if (op == "top") {
+            out += "top 10\n";
+        } else {
+            out += op + " " + word + "\n";
+        }
+    };
+
+    std::deque<Clock::time_point> sent_at;
+    std::string batch;
+    for (int i = 0; i < options.depth; ++i) {
+        make_request(batch);
+        sent_at.push_back(Clock::now());
+    }
+    if (!send_all(fd, batch)) {
+        result.failed = true;
+        close(fd);
+        return;
+    }
+
+    std::string buf;
+    size_t pos = 0;
+    char chunk[64 * 1024];
+    while (!sent_at.empty()) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            result.failed = true;
+            break;
+        }
+        buf.append(chunk, n);
+        size_t done = take_responses(buf, pos, result.errors);
+        auto now = Clock::now();
+        batch.clear();
+        for (size_t i = 0; i < done; ++i) {
+            result.latencies_us.push_back(std::chrono::duration<double, std::micro>(now - sent_at.front()).count());
+            sent_at.pop_front();
+            if (now < stop_at) {
+                make_request(batch);
+                sent_at.push_back(now);
+            }
+        }
+        if (pos > buf.size() / 2) {
+            buf.erase(0, pos);
+            pos = 0;
+        }
+        if (!batch.empty() && !send_all(fd, batch)) {
+            result.failed = true;
+            break;
+        }
+    }
+    close(fd);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--port") {
+            options.port = std::stoi(value);
+        } else if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--unix") {
+            options.unix_path = value;
+        } else if (arg == "--connections") {
+            options.connections = std::stoi(value);
+        } else if (arg == "--depth") {
+            options.depth = std::max(1, std::stoi(value));
+        } else if (arg == "--seconds") {
+            options.seconds = std::stod(value);
+        } else if (arg == "--words") {
+            options.words_file = value;
+        } else if (arg == "--mix") {
+            options.mix.clear();
+            std::stringstream ss(value);
+            std::string op;
+            while (std::getline(ss, op, ',')) {
+                options.mix.push_back(op);
+            }
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::string> words;
+    std::ifstream in(options.words_file);
+    std::string w;
+    while (in >> w) {
+        words.push_back(w);
+    }
+    if (words.empty()) {
+        words = {"apple", "banana", "cherry"};
+    }
+
+    std::vector<ThreadResult> results(options.connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    auto stop_at = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(run_connection, std::cref(options), std::cref(words), i + 1, stop_at,
+                             std::ref(results[i]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    size_t errors = 0;
+    int failed = 0;
+    for (auto& r : results) {
+        all.insert(all.end(), r.latencies_us.begin(), r.latencies_us.end());
+        errors += r.errors;
+        failed += r.failed;
+    }
+    std::sort(all.begin(), all.end());
+
+    std::printf("connections %d, depth %d, %.1f s\n", options.connections, options.depth, elapsed);
+    std::printf("requests %zu (%zu ERR replies, %d failed connections)\n", all.size(), errors, failed);
+    std::printf("throughput %.0f req/s\n", all.size() / elapsed);
+    std::printf("latency us: p50 %.0f  p99 %.0f  p999 %.0f  max %.0f\n", percentile(all, 0.50),
+                percentile(all, 0.99), percentile(all, 0.999), all.empty() ? 0.0 : all.back());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Compares radix_dict builds on the batch workload written by
+# `radix_bench --emit-workload`. Each binary runs WORKLOAD/eval.jsonl three
+# times against a fresh database and the best run counts; speedups are
+# relative to the first binary named.
+#
+#   benchmarks/flavor_report.sh WORKLOAD OUT NAME=BINARY...
+set -e
+
+if [ $# -lt 3 ]; then
+    echo "Usage: $0 WORKLOAD OUT NAME=BINARY..." >&2
+    exit 1
+fi
+workload=$1
+out=$2
+shift 2
+db="$(cd "$workload" && pwd)/eval.db"
+runs=3
+
+{
+    echo "# radix_dict build flavors: $(wc -l < "$workload/eval.jsonl") operations from" \
+         "$workload/eval.jsonl over $(wc -l < "$workload/words.txt") words, best of $runs, 1 thread"
+    printf '# %-8s %10s %9s %9s %9s %11s %8s\n' flavor ops/s p50_us p99_us seconds size_bytes speedup
+} > "$out"
+
+base=
+for spec in "$@"; do
+    name=${spec%%=*}
+    binary=${spec#*=}
+    best=
+    for run in $(seq $runs); do
+        rm -f "$db" "$db-wal" "$db-shm"
+        # batch: N operations (E errors) in Xs, Y ops/s; latency us p50 A p99 B max C
+        line=$("$binary" --batch "$workload/eval.jsonl" --words "$workload/words.txt" \
+                   --db "$db" --threads 1 --output /dev/null 2>&1 >/dev/null | grep '^batch:')
+        ops=$(echo "$line" | sed 's/.*, \([0-9]*\) ops\/s.*/\1/')
+        if [ -z "$best" ] || [ "$ops" -gt "$(echo "$best" | cut -d' ' -f1)" ]; then
+            best="$ops $(echo "$line" | sed 's/.* in \([0-9.]*\)s,.* p50 \([0-9.]*\) p99 \([0-9.]*\) .*/\2 \3 \1/')"
+        fi
+    done
+    rm -f "$db" "$db-wal" "$db-shm"
+    set -- $best
+    base=${base:-$1}
+    size=$(wc -c < "$binary")
+    printf '  %-8s %10s %9s %9s %9s %11s %7sx\n' "$name" "$1" "$2" "$3" "$4" "$size" \
+        "$(awk "BEGIN { printf \"%.2f\", $1 / $base }")" >> "$out"
+done
+
+cat "$out"
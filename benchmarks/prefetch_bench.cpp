@@ -0,0 +1,53 @@
+// Drives DefinitionPrefetcher against an HTTP endpoint (normally the local
+// stub from benchmarks/stub_api.cpp, `make stub_api`) and reports latency
+// and throughput.
+//
+//   ./stub_api --delay-ms 20 &
+//   DICT_API_URL=http://127.0.0.1:8765/api/ ./prefetch_bench [words] [max-in-flight] [requests/s]
+#include "../include/database.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_prefetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include <chrono>
+#include <cstdio>
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 200;
+    PrefetchOptions options;
+    options.max_in_flight = argc > 2 ? std::stoul(argv[2]) : 8;
+    options.requests_per_second = argc > 3 ? std::stod(argv[3]) : 1000;
+    options.burst = options.max_in_flight;
+    options.queue_capacity = count;
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    {
+        DictionaryDB db(":memory:");
+        DefinitionFetcher fetcher;
+        DefinitionResolver resolver(db, fetcher);
+        DefinitionPrefetcher prefetcher(db, resolver, options);
+
+        std::vector<std::string> words;
+        for (size_t i = 0; i < count; ++i) {
+            words.push_back("word" + std::to_string(i));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        prefetcher.prefetch(words);
+        prefetcher.wait_idle();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        PrefetchStats s = prefetcher.stats();
+        std::printf("words %zu, in flight %zu, rate limit %.0f/s\n", count, options.max_in_flight,
+                    options.requests_per_second);
+        std::printf("fetched %zu, not found %zu, failed %zu, skipped %zu, dropped %zu\n",
+                    s.fetched, s.not_found, s.failed, s.skipped, s.dropped);
+        std::printf("latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                    s.latency_p50_ms, s.latency_p99_ms, s.latency_max_ms);
+        std::printf("throughput %.0f/s (wall %.2f s)\n", s.throughput, seconds);
+    }
+    curl_global_cleanup();
+    return 0;
+}
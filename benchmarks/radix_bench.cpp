@@ -0,0 +1,590 @@
+// Benchmark suite for RadixTree and DictionaryDB over generated corpora.
+// Writes one line per (corpus, size, operation) to the report so two runs
+// can be compared with diff, and compares against a saved baseline.
+//
+//   make bench                       run and compare with benchmarks/baseline.txt
+//   make bench-baseline              save the last report as the baseline
+//   ./radix_bench [--sizes 10000,100000,1000000,10000000] [--budget seconds]
+//                 [--repeat 3] [--out FILE] [--baseline FILE] [--threshold 0.10]
+//                 [--strict] [--no-db]
+//   ./radix_bench --emit-workload DIR
+//
+// Every corpus is benchmarked --repeat times and each line reports the run
+// with the median throughput, plus the spread between the fastest and the
+// slowest run. A throughput drop counts as a regression only when it
+// exceeds both --threshold and the spread of the two runs compared, since
+// on a busy machine single runs vary far more than 10%. Regressions are
+// reported; with --strict they also make the exit status 1.
+//
+// Numbers only compare on the same machine: regenerate the baseline
+// (make bench, then make bench-baseline) on each host before relying on
+// the comparison.
+//
+// --emit-workload writes a batch-mode workload instead of benchmarking:
+// DIR/words.txt (a natural corpus to bulk load) and DIR/train.jsonl and
+// DIR/eval.jsonl, two differently seeded mixes of searches, prefixes,
+// inserts and a few suggests for `radix_dict --batch`. The optimised
+// build flavors train PGO on the first and compare builds on the second.
+//
+// Both corpora are generated from fixed seeds with mt19937_64 (whose
+// output is fixed by the standard), so every platform benchmarks the same
+// words:
+//   synthetic  uniformly random a-z strings of 3 to 12 letters
+//   natural    words built from English-like syllables and suffixes with
+//              skewed choices, so prefixes are shared the way real
+//              vocabulary shares them
+#include "../include/database.hpp"
+#include "../include/radix_tree.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    std::vector<size_t> sizes = {10000, 100000, 1000000};
+    double budget = 0.5;          // seconds per query operation
+    size_t repeat = 3;            // runs per corpus; lines report the median
+    std::string out = "benchmarks/report.txt";
+    std::string baseline;
+    double threshold = 0.10;      // throughput drop reported as a regression
+    bool strict = false;          // exit with 1 on a regression
+    bool db = true;
+    size_t db_max_rows = 1000000; // DictionaryDB runs are skipped above this
+};
+
+struct Row {
+    std::string corpus;
+    size_t size = 0;
+    std::string op;
+    size_t ops = 0;
+    double ops_per_sec = 0;
+    double p50_us = 0, p90_us = 0, p99_us = 0, max_us = 0;
+    double peak_rss_mb = 0;
+    double spread = 0;  // (max - min) / median throughput over the runs
+};
+
+// ---- corpora -------------------------------------------------------------
+
+// Uniform double in [0, 1) from the top 53 bits; std::uniform_*_distribution
+// is implementation-defined and would make corpora differ across platforms
+double unit(std::mt19937_64& rng) {
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Index into a table of `n`, biased towards the front
+size_t skewed(std::mt19937_64& rng, size_t n) {
+    double u = unit(rng);
+    return static_cast<size_t>(n * u * u);
+}
+
+std::string synthetic_word(std::mt19937_64& rng) {
+    size_t len = 3 + rng() % 10;
+    std::string w(len, 'a');
+    for (char& c : w) {
+        c = 'a' + rng() % 26;
+    }
+    return w;
+}
+
+std::string natural_word(std::mt19937_64& rng) {
+    static const std::vector<std::string> onsets = {
+        "",   "s",  "t",  "c",  "b",  "p",  "m",  "d",  "r",  "l",  "f",  "h",  "g",  "w",  "n",  "st",
+        "tr", "pr", "br", "ch", "sh", "th", "cr", "gr", "pl", "fl", "cl", "sp", "dr", "sl", "str", "v"};
+    static const std::vector<std::string> nuclei = {"a", "e", "i", "o", "u", "ea", "ou", "ai", "ee", "oo", "ie", "y"};
+    static const std::vector<std::string> codas = {"", "n", "r", "t", "s", "l", "m", "nd", "st", "ng", "ck", "rt", "x", "p"};
+    static const std::vector<std::string> suffixes = {"", "s", "ed", "ing", "er", "ly", "tion", "ness", "able", "ment"};
+    static const size_t syllable_weights[] = {3, 4, 2, 1};  // 1 to 4 syllables
+
+    size_t pick = rng() % 10, syllables = 1;
+    for (size_t acc = 0; syllables <= 4; ++syllables) {
+        acc += syllable_weights[syllables - 1];
+        if (pick < acc) {
+            break;
+        }
+    }
+    std::string w;
+    for (size_t s = 0; s < syllables; ++s) {
+        w += onsets[skewed(rng, onsets.size())];
+        w += nuclei[skewed(rng, nuclei.size())];
+        w += codas[skewed(rng, codas.size())];
+    }
+    w += suffixes[skewed(rng, suffixes.size())];
+    return w;
+}
+
+// `n` distinct words in generation order (fewer if the generator runs dry)
+std::vector<std::string> make_corpus(const std::string& kind, size_t n) {
+    std::mt19937_64 rng(kind == "synthetic" ? 0x5eed1 : 0x5eed2);
+    std::unordered_set<std::string> seen;
+    seen.reserve(n);
+    std::vector<std::string> words;
+    words.reserve(n);
+    for (size_t attempts = 0; words.size() < n && attempts < n * 50; ++attempts) {
+        std::string w = kind == "synthetic" ? synthetic_word(rng) : natural_word(rng);
+        if (seen.insert(w).second) {
+            words.push_back(std::move(w));
+        }
+    }
+    return words;
+}
+
+// ---- measurement ---------------------------------------------------------
+
+// Peak RSS since the last reset_peak_rss(), from /proc when available
+double peak_rss_mb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stod(line.substr(6)) / 1024.0;
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+void reset_peak_rss() {
+    std::ofstream clear("/proc/self/clear_refs");
+    if (clear) {
+        clear << "5";  // resets VmHWM to the current RSS (Linux 4.0+)
+    }
+}
+
+class Bench {
+private:
+    Config config;
+    std::vector<Row> rows;
+    std::string corpus;
+    size_t size = 0;
+
+    Row summarize(const std::string& op, std::vector<double>& lat, double seconds) {
+        Row row{corpus, size, op};
+        row.ops = lat.size();
+        row.ops_per_sec = seconds > 0 ? lat.size() / seconds : 0;
+        if (!lat.empty()) {
+            std::sort(lat.begin(), lat.end());
+            auto at = [&](double q) { return lat[std::min(lat.size() - 1, static_cast<size_t>(q * lat.size()))]; };
+            row.p50_us = at(0.50);
+            row.p90_us = at(0.90);
+            row.p99_us = at(0.99);
+            row.max_us = lat.back();
+        }
+        row.peak_rss_mb = peak_rss_mb();
+        return row;
+    }
+
+public:
+    explicit Bench(const Config& config) : config(config) {}
+
+    void begin(const std::string& corpus_name, size_t corpus_size) {
+        corpus = corpus_name;
+        size = corpus_size;
+        reset_peak_rss();
+    }
+
+    // Times fn(i) for i = 0, 1, ... until `count` calls or the time budget
+    // (unless `whole`, which always makes all `count` calls)
+    template <typename F> void run(const std::string& op, size_t count, F&& fn, bool whole = false) {
+        std::vector<double> lat;
+        lat.reserve(whole ? count : std::min<size_t>(count, 1 << 20));
+        auto start = Clock::now();
+        auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.budget));
+        for (size_t i = 0; i < count; ++i) {
+            auto t0 = Clock::now();
+            fn(i);
+            auto t1 = Clock::now();
+            lat.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            if (!whole && t1 > deadline) {
+                break;
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        rows.push_back(summarize(op, lat, seconds));
+        print(rows.back(), std::cout);
+    }
+
+    // A single timed call doing `units` operations (file loads and saves)
+    template <typename F> void once(const std::string& op, size_t units, F&& fn) {
+        auto start = Clock::now();
+        fn();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        Row row{corpus, size, op};
+        row.ops = units;
+        row.ops_per_sec = units / seconds;
+        row.p50_us = row.p90_us = row.p99_us = row.max_us = seconds * 1e6;
+        row.peak_rss_mb = peak_rss_mb();
+        rows.push_back(row);
+        print(rows.back(), std::cout);
+    }
+
+    static void print(const Row& r, std::ostream& out) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-9s %9zu %-18s %9zu %13.0f %10.2f %10.2f %10.2f %12.2f %9.1f %8.1f\n",
+                      r.corpus.c_str(), r.size, r.op.c_str(), r.ops, r.ops_per_sec, r.p50_us, r.p90_us, r.p99_us,
+                      r.max_us, r.peak_rss_mb, r.spread * 100);
+        out << line;
+    }
+
+    static void header(std::ostream& out) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "# %-7s %9s %-18s %9s %13s %10s %10s %10s %12s %9s %8s\n", "corpus", "size",
+                      "op", "ops", "ops/s", "p50_us", "p90_us", "p99_us", "max_us", "rss_mb", "spread%");
+        out << line;
+    }
+
+    // One row per (corpus, size, operation) in first-run order: the run
+    // with the median throughput, with the spread over all runs
+    std::vector<Row> results() const {
+        std::vector<Row> merged;
+        std::map<std::tuple<std::string, size_t, std::string>, std::vector<const Row*>> runs;
+        for (const Row& r : rows) {
+            auto& same = runs[{r.corpus, r.size, r.op}];
+            if (same.empty()) {
+                merged.push_back(r);
+            }
+            same.push_back(&r);
+        }
+        for (Row& m : merged) {
+            auto& same = runs[{m.corpus, m.size, m.op}];
+            std::sort(same.begin(), same.end(),
+                      [](const Row* a, const Row* b) { return a->ops_per_sec < b->ops_per_sec; });
+            m = *same[same.size() / 2];
+            if (m.ops_per_sec > 0) {
+                m.spread = (same.back()->ops_per_sec - same.front()->ops_per_sec) / m.ops_per_sec;
+            }
+        }
+        return merged;
+    }
+    const Config& options() const { return config; }
+};
+
+// ---- workloads -----------------------------------------------------------
+
+void bench_tree(Bench& bench, const std::vector<std::string>& words) {
+    std::mt19937_64 rng(42);
+    const size_t n = words.size();
+    auto random_word = [&]() -> const std::string& { return words[rng() % n]; };
+    std::filesystem::path tmp = std::filesystem::temp_directory_path();
+
+    RadixTree tree;
+    bench.run("insert", n, [&](size_t i) { tree.insert(words[i]); }, true);
+
+    std::vector<std::string> hits, misses;
+    for (size_t i = 0; i < 100000; ++i) {
+        hits.push_back(random_word());
+        std::string miss = random_word();
+        miss.back() = '0';  // corpora are letters only, so this never exists
+        misses.push_back(std::move(miss));
+    }
+    size_t found = 0;
+    bench.run("search_hit", hits.size(), [&](size_t i) { found += tree.search(hits[i]); });
+    bench.run("search_miss", misses.size(), [&](size_t i) { found += tree.search(misses[i]); });
+
+    for (size_t len : {1, 2, 3, 4}) {
+        std::vector<std::string> prefixes;
+        while (prefixes.size() < 10000) {
+            const std::string& w = random_word();
+            if (w.size() >= len) {
+                prefixes.push_back(w.substr(0, len));
+            }
+        }
+        size_t results = 0;
+        bench.run("starts_with_" + std::to_string(len), prefixes.size(),
+                  [&](size_t i) { results += tree.starts_with(prefixes[i]).size(); });
+    }
+
+    std::vector<std::string> typos;
+    for (size_t i = 0; i < 1000; ++i) {
+        std::string w = random_word();
+        w[rng() % w.size()] = 'a' + rng() % 26;
+        typos.push_back(std::move(w));
+    }
+    for (int distance : {1, 2}) {
+        size_t results = 0;
+        bench.run("suggest_d" + std::to_string(distance), typos.size(),
+                  [&](size_t i) { results += tree.suggest(typos[i], distance).size(); });
+    }
+
+    // Skew the statistics so the ranking has something to do
+    for (size_t i = 0; i < n; ++i) {
+        tree.recordUsage(words[std::min(n - 1, skewed(rng, n))]);
+    }
+    bench.run("top_10", 1000, [&](size_t) { tree.getTopNWords(10); });
+    bench.run("top_1000", 1000, [&](size_t) { tree.getTopNWords(1000); });
+
+    std::string stats_path = (tmp / "radix_bench_stats.txt").string();
+    bench.once("save_stats", n, [&] { tree.saveStats(stats_path); });
+    bench.once("load_stats", n, [&] { tree.loadStats(stats_path); });
+    std::filesystem::remove(stats_path);
+    tree = RadixTree();  // free before loadWords builds a second tree
+
+    std::string words_path = (tmp / "radix_bench_words.txt").string();
+    {
+        std::ofstream out(words_path);
+        for (const auto& w : words) {
+            out << w << '\n';
+        }
+    }
+    bench.once("load_words", n, [&] {
+        RadixTree loaded;
+        loaded.loadWords(words_path);
+    });
+    std::filesystem::remove(words_path);
+}
+
+void bench_db(Bench& bench, const std::vector<std::string>& words) {
+    std::string path = (std::filesystem::temp_directory_path() / "radix_bench.db").string();
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    std::mt19937_64 rng(43);
+    const size_t n = words.size();
+    {
+        DictionaryDBOptions options;
+        options.cache.max_bytes = 0;  // measure SQLite, not the cache
+        DictionaryDB db(path, options);
+
+        std::vector<std::pair<std::string, std::string>> batch;
+        bench.once("db_add_words", n, [&] {
+            for (size_t i = 0; i < n; ++i) {
+                batch.emplace_back(words[i], "a definition of " + words[i] + " mentioning " + words[rng() % n] +
+                                                 " and " + words[rng() % n]);
+                if (batch.size() == 50000 || i + 1 == n) {
+                    db.add_words(batch);
+                    batch.clear();
+                }
+            }
+        });
+        bench.run("db_get_meaning", 100000, [&](size_t) { db.get_meaning(words[rng() % n]); });
+        bench.run("db_word_exists", 100000, [&](size_t) { db.word_exists(words[rng() % n]); });
+        bench.run("db_record_search", 100000, [&](size_t) { db.record_search(words[rng() % n]); });
+        bench.once("db_flush", 1, [&] { db.flush(); });
+        bench.run("db_search_defs", 10000, [&](size_t) { db.search_definitions(words[rng() % n], 10); });
+    }
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
+
+// ---- batch workload --------------------------------------------------------
+
+// Operations for radix_dict --batch over a dictionary of `known` words;
+// `unseen` words are searched for (misses) and inserted
+void write_operations(const std::string& path, uint64_t seed, const std::vector<std::string>& known,
+                      const std::vector<std::string>& unseen, size_t count) {
+    std::ofstream out(path);
+    std::mt19937_64 rng(seed);
+    size_t next_insert = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& word = known[skewed(rng, known.size())];
+        size_t pick = rng() % 100;
+        if (i % 20000 == 19999) {
+            // Suggest walks the whole tree, so only a few; drop a letter
+            std::string typo = word;
+            typo.erase(rng() % typo.size(), 1);
+            out << "{\"op\":\"suggest\",\"word\":\"" << typo << "\"}\n";
+        } else if (pick < 45) {
+            out << "{\"op\":\"search\",\"word\":\"" << word << "\"}\n";
+        } else if (pick < 55) {
+            out << "{\"op\":\"search\",\"word\":\"" << unseen[rng() % unseen.size()] << "\"}\n";
+        } else if (pick < 85) {
+            size_t len = std::min(word.size(), static_cast<size_t>(3 + skewed(rng, 3)));
+            out << "{\"op\":\"prefix\",\"prefix\":\"" << word.substr(0, len) << "\",\"limit\":20}\n";
+        } else {
+            out << "{\"op\":\"insert\",\"word\":\"" << unseen[next_insert++ % unseen.size()] << "\"}\n";
+        }
+    }
+}
+
+bool emit_workload(const std::string& dir) {
+    std::filesystem::create_directories(dir);
+    std::vector<std::string> words = make_corpus("natural", 100000);
+    size_t known = words.size() * 9 / 10;
+    std::vector<std::string> dictionary(words.begin(), words.begin() + known);
+    std::vector<std::string> unseen(words.begin() + known, words.end());
+
+    std::ofstream out(dir + "/words.txt");
+    for (const std::string& w : dictionary) {
+        out << w << "\n";
+    }
+    out.close();
+    write_operations(dir + "/train.jsonl", 1, dictionary, unseen, 100000);
+    write_operations(dir + "/eval.jsonl", 2, dictionary, unseen, 100000);
+    if (!out) {
+        std::cerr << "Failed to write the workload to " << dir << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << dictionary.size() << " words and 2 x 100000 operations to " << dir << std::endl;
+    return true;
+}
+
+// ---- report and baseline -------------------------------------------------
+
+std::string cpu_model() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            return line.substr(line.find(':') + 2);
+        }
+    }
+    return "unknown";
+}
+
+void write_report(const Bench& bench, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return;
+    }
+    out << "# radix_bench report: one line per corpus/size/operation from the\n"
+        << "# median of " << bench.options().repeat << " runs; latencies are per call, rss_mb is the peak\n"
+        << "# since that corpus size began, spread% is fastest minus slowest run\n"
+        << "# cpu: " << cpu_model() << ", " << std::thread::hardware_concurrency() << " threads\n"
+        << "# compiler: " << __VERSION__ << "\n";
+    Bench::header(out);
+    for (const Row& row : bench.results()) {
+        Bench::print(row, out);
+    }
+}
+
+// Returns the number of regressions
+int compare(const Bench& bench, const std::string& path, double threshold) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "\nNo baseline at " << path << " (make bench-baseline saves one)" << std::endl;
+        return 0;
+    }
+    std::map<std::tuple<std::string, size_t, std::string>, Row> base;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(line);
+        Row r;
+        if (iss >> r.corpus >> r.size >> r.op >> r.ops >> r.ops_per_sec >> r.p50_us >> r.p90_us >> r.p99_us >>
+            r.max_us >> r.peak_rss_mb) {
+            if (iss >> r.spread) {  // older reports have no spread column
+                r.spread /= 100;
+            }
+            base[{r.corpus, r.size, r.op}] = r;
+        }
+    }
+
+    std::printf("\nAgainst %s (regression: throughput down more than %.0f%% and more than the\n"
+                "spread of both runs)\n",
+                path.c_str(), threshold * 100);
+    std::printf("%-9s %9s %-18s %13s %13s %8s %9s %8s\n", "corpus", "size", "op", "base ops/s", "ops/s", "change",
+                "p99", "noise");
+    int regressions = 0;
+    for (const Row& r : bench.results()) {
+        auto it = base.find({r.corpus, r.size, r.op});
+        if (it == base.end() || it->second.ops_per_sec <= 0) {
+            continue;
+        }
+        double change = r.ops_per_sec / it->second.ops_per_sec - 1;
+        double p99_change = it->second.p99_us > 0 ? r.p99_us / it->second.p99_us - 1 : 0;
+        double noise = it->second.spread + r.spread;
+        bool regressed = change < -std::max(threshold, noise);
+        regressions += regressed;
+        std::printf("%-9s %9zu %-18s %13.0f %13.0f %+7.1f%% %+8.1f%% %7.1f%%%s\n", r.corpus.c_str(), r.size,
+                    r.op.c_str(), it->second.ops_per_sec, r.ops_per_sec, change * 100, p99_change * 100, noise * 100,
+                    regressed ? "  REGRESSION" : "");
+    }
+    std::printf("%d regression(s)\n", regressions);
+    return regressions;
+}
+
+std::vector<size_t> parse_sizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        sizes.push_back(std::stoul(item));
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value" << std::endl;
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--sizes") {
+            config.sizes = parse_sizes(value());
+        } else if (arg == "--budget") {
+            config.budget = std::stod(value());
+        } else if (arg == "--out") {
+            config.out = value();
+        } else if (arg == "--baseline") {
+            config.baseline = value();
+        } else if (arg == "--repeat") {
+            config.repeat = std::max<size_t>(1, std::stoul(value()));
+        } else if (arg == "--threshold") {
+            config.threshold = std::stod(value());
+        } else if (arg == "--strict") {
+            config.strict = true;
+        } else if (arg == "--no-db") {
+            config.db = false;
+        } else if (arg == "--emit-workload") {
+            return emit_workload(value()) ? 0 : 1;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--sizes N,N,...] [--budget seconds] [--repeat N] [--out FILE] [--baseline FILE]"
+                         " [--threshold fraction] [--strict] [--no-db] | --emit-workload DIR"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    Bench bench(config);
+    Bench::header(std::cout);
+    for (const std::string kind : {"synthetic", "natural"}) {
+        for (size_t size : config.sizes) {
+            std::vector<std::string> words = make_corpus(kind, size);
+            for (size_t run = 0; run < config.repeat; ++run) {
+                bench.begin(kind, words.size());
+                bench_tree(bench, words);
+                if (config.db && size <= config.db_max_rows) {
+                    bench_db(bench, words);
+                }
+            }
+        }
+    }
+
+    write_report(bench, config.out);
+    std::cout << "\nWrote " << config.out << std::endl;
+    if (!config.baseline.empty() && compare(bench, config.baseline, config.threshold) > 0 && config.strict) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Stand-in for the dictionary API, for prefetch_bench and anything else
+// that honours DICT_API_URL. Every GET is answered with one made-up sense
+// for the last path segment, or 404 when that word starts with "missing",
+// after --delay-ms. Connections are kept alive and each is served on its
+// own thread.
+//
+//   ./stub_api [--port N] [--delay-ms N]
+//   DICT_API_URL=http://127.0.0.1:8765/api/ ./prefetch_bench
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Options {
+    int port = 8765;
+    int delay_ms = 20;
+};
+
+bool send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Last segment of the request target, %XX escapes decoded
+std::string word_from(const std::string& target) {
+    std::string segment = target.substr(target.find_last_of('/') + 1);
+    segment = segment.substr(0, segment.find('?'));
+    std::string word;
+    for (size_t i = 0; i < segment.size(); ++i) {
+        if (segment[i] == '%' && i + 2 < segment.size()) {
+            word += static_cast<char>(std::strtol(segment.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            word += segment[i];
+        }
+    }
+    return word;
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string response_for(const std::string& word) {
+    std::string status = "200 OK";
+    std::string body;
+    if (word.compare(0, 7, "missing") == 0) {
+        status = "404 Not Found";
+        body = "{\"title\":\"No Definitions Found\"}";
+    } else {
+        body = "[{\"word\":" + json_string(word) +
+               ",\"meanings\":[{\"partOfSpeech\":\"noun\",\"definitions\":[{\"definition\":" +
+               json_string("A stub definition of " + word + ".") + "}]}]}]";
+    }
+    return "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\nContent-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+void serve(int fd, const Options& options) {
+    std::string buf;
+    char chunk[4096];
+    bool open = true;
+    while (open) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            break;
+        }
+        buf.append(chunk, n);
+        // Requests without a body; answer each complete header block in order
+        size_t end;
+        while (open && (end = buf.find("\r\n\r\n")) != std::string::npos) {
+            std::string head = buf.substr(0, end);
+            buf.erase(0, end + 4);
+            size_t target = head.find(' ') + 1;
+            std::string word = word_from(head.substr(target, head.find(' ', target) - target));
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.delay_ms));
+            open = send_all(fd, response_for(word)) &&
+                   head.find("Connection: close") == std::string::npos;
+        }
+    }
+    close(fd);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--port") {
+            options.port = std::stoi(value);
+        } else if (arg == "--delay-ms") {
+            options.delay_ms = std::max(0, std::stoi(value));
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 128) != 0) {
+        std::cerr << "Cannot listen on 127.0.0.1:" << options.port << std::endl;
+        return 1;
+    }
+    std::cout << "stub_api on http://127.0.0.1:" << options.port << "/api/, " << options.delay_ms
+              << " ms per reply" << std::endl;
+
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::thread(serve, fd, std::cref(options)).detach();
+    }
+}
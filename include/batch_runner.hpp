@@ -0,0 +1,93 @@
+#pragma once
+
+#include "json.hpp"
+#include "query_engine.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Non-interactive batch mode (`radix_dict --batch FILE`).
+//
+// Input is JSONL, one operation per line:
+//   {"id": 1, "op": "search",  "word": "apple"}
+//   {"id": 2, "op": "prefix",  "prefix": "app", "limit": 20}
+//   {"id": 3, "op": "suggest", "word": "aple"}
+//   {"id": 4, "op": "meaning", "word": "apple"}
+//   {"id": 5, "op": "insert",  "word": "appletini"}
+// "id" is optional and echoed back verbatim (string or number). Output is
+// one JSONL result per input line, in input order:
+//   {"line":1,"id":1,"op":"search","ok":true,"found":true,"us":0.8}
+//   {"line":9,"ok":false,"error":"unknown op"}
+// "us" is the time spent executing the operation in microseconds.
+struct BatchOptions {
+    size_t threads = 0;           // 0 = one per hardware thread
+    size_t batch_size = 256;      // operations handed to a worker at a time
+    size_t window = 1 << 16;      // max lines read ahead of the writer
+    size_t flush_bytes = 1 << 20; // output is written in chunks of this size
+};
+
+struct BatchStats {
+    uint64_t operations = 0;
+    uint64_t errors = 0;
+    double seconds = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    double max_us = 0;
+};
+
+// Runs a JSONL stream through a QueryEngine on a pool of workers.
+// Operations are sharded by their key (the word or prefix), so operations
+// on the same key run in input order on the same worker while unrelated
+// keys proceed in parallel. A prefix query may therefore see an insert of a
+// different word from a later line, or miss one from an earlier line.
+// Results go through a reorder window and are written in input order, in
+// large buffered chunks.
+class BatchRunner {
+private:
+    struct Operation {
+        uint64_t seq;       // position among the operations, 1-based
+        uint64_t line;      // input line number, blank lines included
+        json::Value request;
+        std::string error;  // set when the line did not parse
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::vector<Operation>> batches;
+        bool closed = false;
+    };
+
+    QueryEngine& engine;
+    BatchOptions options;
+
+    // Reorder window: slot seq % window holds the result for operation seq
+    enum SlotState : char { Empty, Done, Failed };
+    std::mutex results_mutex;
+    std::condition_variable results_cv;
+    std::vector<std::string> results;
+    std::vector<char> states;
+    std::vector<float> latencies;
+    uint64_t next_to_write = 1;
+    uint64_t total = 0;        // operations read; final once input_done
+    bool input_done = false;
+
+    void worker_loop(Shard& shard);
+    // Formats the result line; `micros` is the execution time
+    bool execute(const Operation& op, std::string& result, float& micros);
+    void writer_loop(std::ostream& out, std::vector<float>& all_latencies, uint64_t& errors);
+
+public:
+    BatchRunner(QueryEngine& engine, const BatchOptions& options = BatchOptions());
+
+    // Reads `in` to EOF and writes results to `out`
+    BatchStats run(std::istream& in, std::ostream& out);
+
+    // Prevent copying
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "radix_map.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BookmarkStoreOptions {
+    // Compact once the journal holds this many records and at least as
+    // many as there are bookmarks
+    size_t compact_min_records = 1024;
+    bool sync_each_write = false;   // fdatasync every record, not just the flush to the OS
+};
+
+// A user's bookmarks (word -> note) in a RadixMap, persisted as a snapshot
+// plus an append-only journal:
+//
+//   bookmarks.txt      snapshot, one "word|note" line per bookmark
+//   bookmarks.journal  "+word|note" or "-word" per change since the snapshot
+//
+// Each add or remove appends one record with a single write(2), so a
+// crash loses at most the record being written; a torn last line is
+// ignored on replay. When the journal grows past the bookmarks it
+// describes, the snapshot is rewritten (to a temporary file, then
+// renamed) and the journal truncated. Replaying a journal onto a snapshot
+// that already contains it is harmless, so a crash between those two
+// steps loses nothing.
+class BookmarkStore {
+private:
+    RadixMap<std::string> entries;
+    BookmarkStoreOptions options;
+    std::string snapshotPath;
+    std::string journalPath;
+    int journalFd = -1;
+    size_t journalRecords = 0;
+
+    bool loadSnapshot();
+    void replayJournal();
+    bool append(const std::string& record);
+    void maybeCompact();
+
+public:
+    explicit BookmarkStore(const BookmarkStoreOptions& options = BookmarkStoreOptions());
+    ~BookmarkStore();
+
+    // Loads `snapshot` and replays its journal; false if the journal
+    // cannot be opened for appending
+    bool open(const std::string& snapshot);
+    // Compacts and closes the journal
+    void close();
+
+    // Adds or replaces a bookmark
+    bool add(const std::string& word, const std::string& note);
+    // False if there was no such bookmark
+    bool remove(const std::string& word);
+    const std::string* find(const std::string& word) const { return entries.find(word); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Bookmarks starting with `prefix`, in word order, one page at a time
+    std::vector<std::pair<std::string, std::string>> list(const std::string& prefix, size_t offset,
+                                                          size_t limit) const;
+    size_t count(const std::string& prefix) const { return entries.countPrefix(prefix); }
+    // Bookmarked words within `max_distance` edits of `word`, closest first
+    std::vector<std::string> fuzzy(const std::string& word, int max_distance = 2, size_t limit = 20) const;
+
+    // Rewrites the snapshot and empties the journal
+    bool compact();
+
+    // Prevent copying
+    BookmarkStore(const BookmarkStore&) = delete;
+    BookmarkStore& operator=(const BookmarkStore&) = delete;
+};
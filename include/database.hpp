@@ -1,27 +1,187 @@
 #pragma once
+#include "definition_cache.hpp"
 #include <sqlite3.h>
+#include <array>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// What record_search/add_word do when the write-behind queue is full
+enum class WriteBackpressure {
+    Block,          // wait for the writer thread to drain the queue
+    DropSearches    // drop search events (definitions still wait)
+};
+
+// Connection tuning applied when the database is opened
+struct DictionaryDBOptions {
+    bool wal = true;                         // journal_mode=WAL instead of rollback journal
+    std::string synchronous = "NORMAL";      // fsync only at WAL checkpoints
+    long long mmap_size = 256LL << 20;       // bytes of the file to memory-map
+    int cache_size_kib = 64 * 1024;          // page cache size, per connection
+    int busy_timeout_ms = 5000;              // wait this long on a locked database
+    
+    // Read-only connections for get_meaning and the other lookups, so
+    // several threads can read at once. 0 keeps every read on the write
+    // connection. Needs WAL and a file database; ignored otherwise.
+    size_t read_connections = 0;
+    
+    // Write-behind queue
+    size_t write_queue_capacity = 8192;      // pending distinct words before backpressure
+    size_t flush_batch = 256;                // wake the writer at this many pending words
+    int flush_interval_ms = 100;             // ...or after this long
+    int write_retries = 5;                   // failed batches retried (one interval apart) before being dropped
+    WriteBackpressure backpressure = WriteBackpressure::Block;
+    int search_daily_retention_days = 90;    // per-day search buckets kept
+    
+    // In-memory definition cache in front of get_meaning
+    DefinitionCacheOptions cache;
+};
+
+// One hit from a full-text search over meanings
+struct DefinitionMatch {
+    std::string word;
+    std::string snippet;  // matched terms wrapped in [ ]
+    double score;         // BM25; lower is a better match
+};
+
 class DictionaryDB {
 private:
-    sqlite3* db;
+    // Every statement is prepared once at construction and reused
+    enum class Statement {
+        AddWord,
+        GetMeaning,
+        WordExists,
+        RecordSearch,
+        RecordSearchDaily,
+        SearchHistory,
+        DailyCounts,
+        PruneDaily,
+        SearchDefinitions,
+        Count
+    };
+    
+    // One SQLite handle with its own copy of every prepared statement.
+    // Connections are opened with SQLITE_OPEN_NOMUTEX, so each one must only
+    // be used by one thread at a time.
+    struct Connection {
+        sqlite3* handle = nullptr;
+        std::array<sqlite3_stmt*, static_cast<size_t>(Statement::Count)> statements{};
+        
+        sqlite3_stmt* statement(Statement id) const { return statements[static_cast<size_t>(id)]; }
+    };
+    
+    // Checks out a connection for reads: an idle one from the pool, or the
+    // write connection (holding db_mutex) when there is no pool. Returned
+    // when the lease goes out of scope.
+    class ReadLease {
+    private:
+        DictionaryDB& owner;
+        Connection* conn;
+        std::unique_lock<std::mutex> write_lock;
+        
+    public:
+        explicit ReadLease(DictionaryDB& owner);
+        ~ReadLease();
+        ReadLease(const ReadLease&) = delete;
+        ReadLease& operator=(const ReadLease&) = delete;
+        
+        sqlite3_stmt* statement(Statement id) const { return conn->statement(id); }
+    };
+    
+    Connection primary;   // the only connection that writes
+    DictionaryDBOptions options;
+    std::mutex db_mutex;  // guards the write connection and its statements
+    DefinitionCache cache;
+    
+    // Read pool
+    std::vector<Connection> readers;
+    std::vector<Connection*> idle_readers;
+    std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+    
+    // Write-behind queue. Producers coalesce into the pending maps (search
+    // events become per-word count deltas, definitions keep the latest
+    // meaning); the writer thread swaps them out and commits each batch in
+    // a single transaction.
+    std::mutex queue_mutex;
+    std::condition_variable writer_cv;   // wakes the writer
+    std::condition_variable space_cv;    // wakes producers blocked on a full queue
+    std::condition_variable flushed_cv;  // wakes flush() callers
+    std::unordered_map<std::string, int> pending_searches;
+    std::unordered_map<std::string, std::string> pending_words;
+    // Being committed; only changed under both queue_mutex and db_mutex
+    // once the writer has let go of queue_mutex
+    std::unordered_map<std::string, std::string> inflight_words;
+    bool writing = false;
+    bool flush_requested = false;
+    bool stopping = false;
+    size_t dropped_searches = 0;
+    size_t lost_writes = 0;          // definitions and search counts given up on
+    long long last_pruned_day = -1;  // writer thread only
+    std::thread writer;
+    
     bool create_tables();
+    bool table_exists(const std::string& name);
+    bool open_connection(Connection& conn, const std::string& path, int flags);
+    void close_connection(Connection& conn);
+    void apply_options(sqlite3* handle);
+    void prepare_statements(Connection& conn);
+    void open_read_pool(const std::string& path);
+    size_t pending_count() const { return pending_searches.size() + pending_words.size(); }
+    // Waits for queue space; false if the event should be dropped instead
+    bool wait_for_space(std::unique_lock<std::mutex>& lock, bool droppable);
+    void writer_loop();
+    // False (after rolling back) if any statement or the commit failed
+    bool write_batch(const std::unordered_map<std::string, std::string>& words,
+                     const std::unordered_map<std::string, int>& searches);
     
 public:
-    // Constructor/Destructor
-    DictionaryDB(const std::string& db_path);
+    // Constructor/Destructor. Relative paths live under ~/.local/share/dictionary.
+    // All public methods are safe to call from several threads.
+    DictionaryDB(const std::string& db_path,
+                 const DictionaryDBOptions& options = DictionaryDBOptions());
     ~DictionaryDB();
     
-    // Word operations
+    // Word operations. add_word is queued for the writer thread; readers of
+    // this object see the new meaning immediately.
     bool add_word(const std::string& word, const std::string& meaning);
+    // Inserts the whole batch in one transaction; returns rows written, 0 on
+    // failure. A word given more than once ends up with its last meaning,
+    // and the batch replaces any meaning add_word queued before it.
+    size_t add_words(const std::vector<std::pair<std::string, std::string>>& batch);
     std::string get_meaning(const std::string& word);
     bool word_exists(const std::string& word);
     
-    // Stats tracking
+    // Negative caching: remember for a while that no definition exists
+    // anywhere (e.g. the online lookup failed), so callers can skip the fetch
+    void mark_missing(const std::string& word);
+    bool known_missing(const std::string& word);
+    DefinitionCacheStats cache_stats() const { return cache.stats(); }
+    
+    // Reverse lookup: words whose meaning contains all terms of `query`,
+    // best BM25 match first
+    std::vector<DefinitionMatch> search_definitions(const std::string& query, int limit = 10);
+    
+    // Stats tracking. record_search is queued and coalesced per word; the
+    // writer keeps one running total per word plus per-day buckets.
     void record_search(const std::string& word);
+    // Most recently searched words with their total counts
     std::vector<std::pair<std::string, int>> get_search_history(int limit = 10);
+    // (YYYY-MM-DD, count) for the last `days` UTC days with searches
+    std::vector<std::pair<std::string, int>> get_daily_counts(const std::string& word, int days = 30);
+    
+    // Blocks until every queued write is committed, or given up on after
+    // options.write_retries failed attempts
+    void flush();
+    size_t dropped_search_events();
+    // Queued definitions and search counts dropped because their batch
+    // kept failing to commit
+    size_t lost_write_events();
     
     // Prevent copying
     DictionaryDB(const DictionaryDB&) = delete;
@@ -0,0 +1,75 @@
+#pragma once
+#include "radix_tree.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimized acyclic word automaton (DAWG) built from a RadixTree.
+//
+// Where the radix tree only shares prefixes, the DAWG also merges identical
+// suffixes ("-tion", "-ing", ...), which is where large read-only word lists
+// spend most of their bytes. Every state records how many words are reachable
+// from it, so each word maps to its lexicographic rank (a minimal perfect
+// hash). Frequencies are kept in a rank-indexed array, which makes the
+// automaton behave like an FST with frequency outputs: all words under a
+// prefix form one contiguous rank range, and top-K is a range-max query.
+//
+// The automaton is immutable and stored in flat arrays; rebuild it from the
+// tree after edits.
+class Dawg {
+private:
+  // Per state: [edgeBegin[s], edgeBegin[s + 1]) indexes its outgoing edges,
+  // which are sorted by label.
+  std::vector<uint32_t> edgeBegin;
+  // Words reachable from the state, with the final bit in the top bit.
+  std::vector<uint32_t> stateInfo;
+  std::vector<char> edgeLabel;
+  std::vector<uint32_t> edgeTarget;
+  // Frequency of the word with lexicographic rank i
+  std::vector<uint32_t> freqs;
+  // Sparse table of argmax over blocks of freqs, for range-max queries
+  std::vector<std::vector<uint32_t>> blockMax;
+
+  static constexpr uint32_t FINAL_BIT = 0x80000000u;
+  static constexpr size_t BLOCK = 64;
+
+  bool isFinal(uint32_t state) const {
+    return (stateInfo[state] & FINAL_BIT) != 0;
+  }
+  uint32_t wordsBelow(uint32_t state) const {
+    return stateInfo[state] & ~FINAL_BIT;
+  }
+  int64_t findEdge(uint32_t state, char c) const;
+  // Walks `prefix`; returns false if it leaves the automaton
+  bool walk(const std::string &prefix, uint32_t &state, uint32_t &rank) const;
+  std::string wordAt(uint32_t rank) const;
+  void collect_words(uint32_t state, std::string &prefix,
+                     std::vector<std::string> &words) const;
+  void suggestHelper(uint32_t state, std::string &prefix,
+                     const std::string &word, const std::vector<int> &prevRow,
+                     int max_distance, std::vector<std::string> &res) const;
+  void buildRangeMax();
+  uint32_t argmaxRange(uint32_t lo, uint32_t hi) const;
+  std::vector<std::pair<std::string, int>> topInRange(uint32_t lo, uint32_t hi,
+                                                      int K) const;
+
+public:
+  Dawg();
+  static Dawg build(const RadixTree &tree);
+
+  bool search(const std::string &key) const;
+  std::vector<std::string> starts_with(const std::string &prefix) const;
+  std::vector<std::string> suggest(const std::string &word,
+                                   int max_distance = 2) const;
+  std::vector<std::pair<std::string, int>> getTopNWords(int N) const;
+  // Most frequent K words starting with `prefix`
+  std::vector<std::pair<std::string, int>>
+  topKWithPrefix(const std::string &prefix, int K) const;
+
+  size_t wordCount() const { return freqs.size(); }
+  size_t stateCount() const { return stateInfo.size(); }
+  size_t edgeCount() const { return edgeTarget.size(); }
+  // Heap bytes of the flat arrays
+  size_t memoryUsage() const;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct DefinitionCacheOptions {
+    size_t max_bytes = 32 << 20;     // budget across all shards
+    size_t shards = 16;
+    int negative_ttl_seconds = 300;  // how long "no definition found" is remembered
+};
+
+struct DefinitionCacheStats {
+    uint64_t hits = 0;
+    uint64_t negative_hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Sharded, size-bounded LRU cache of definitions. Meanings are stored as
+// shared immutable strings, so a hit hands out a reference instead of a copy.
+// Words known to have no definition can be cached as negative entries that
+// expire after a TTL.
+class DefinitionCache {
+public:
+    enum class Status { Hit, Negative, Miss };
+    
+    struct Lookup {
+        Status status = Status::Miss;
+        std::shared_ptr<const std::string> meaning;  // set on Hit
+    };
+    
+    explicit DefinitionCache(const DefinitionCacheOptions& options = DefinitionCacheOptions());
+    
+    Lookup get(const std::string& word);
+    void put(const std::string& word, std::shared_ptr<const std::string> meaning);
+    void put_negative(const std::string& word);
+    void erase(const std::string& word);
+    
+    // For values read from the database: take a token before reading, then
+    // fill() with it. The fill is dropped if put, put_negative or erase
+    // touched the word's shard in between, so a slow read can never replace
+    // a newer write with the row it saw.
+    uint64_t fill_token(const std::string& word);
+    void fill(const std::string& word, std::shared_ptr<const std::string> meaning, uint64_t token);
+    
+    DefinitionCacheStats stats() const;
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Entry {
+        std::string word;
+        std::shared_ptr<const std::string> meaning;  // null for negative entries
+        Clock::time_point expires;
+        size_t bytes;
+    };
+    
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;  // most recently used first
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t generation = 0;  // bumped by every write, not by fills
+    };
+    
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shard_budget;
+    Clock::duration negative_ttl;
+    
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> negative_hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    
+    Shard& shard_for(const std::string& word);
+    void write(const std::string& word, std::shared_ptr<const std::string> meaning,
+               Clock::time_point expires);
+    void insert_locked(Shard& shard, const std::string& word, std::shared_ptr<const std::string> meaning,
+                       Clock::time_point expires);
+    void remove_locked(Shard& shard, std::list<Entry>::iterator it);
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One sense of a word as returned by the dictionary API
+struct Sense {
+    std::string part_of_speech;
+    std::string definition;
+    std::string example;  // empty when the API has none
+};
+
+struct FetchResult {
+    enum class Status {
+        Ok,        // at least one sense
+        NotFound,  // the API answered but has no definition
+        Error      // network, HTTP or parse failure; worth retrying later
+    };
+
+    Status status = Status::Error;
+    std::vector<Sense> senses;
+    long http_status = 0;
+    std::string error;
+
+    bool ok() const { return status == Status::Ok; }
+};
+
+// Looks words up on a dictionaryapi.dev compatible endpoint. The CURL handle
+// lives as long as the fetcher, so consecutive lookups reuse its connection
+// (and TLS session) instead of reconnecting. fetch() may be called from any
+// thread; calls are serialized on the handle. fetch() is virtual so tools
+// such as radix_replay can stand in for the network.
+class DefinitionFetcher {
+private:
+    CURL* curl;
+    std::mutex mutex;
+    std::string base_url;
+    long timeout_ms;
+
+public:
+    static const char* DEFAULT_URL;
+
+    // The word is appended (URL-escaped) to `base_url`. An empty base_url
+    // uses $DICT_API_URL when set and DEFAULT_URL otherwise.
+    explicit DefinitionFetcher(const std::string& base_url = "", long timeout_ms = 5000);
+    virtual ~DefinitionFetcher();
+
+    void set_base_url(const std::string& url);
+    std::string get_base_url();
+
+    virtual FetchResult fetch(const std::string& word);
+
+    // Text stored in the database and shown to the user; same layout as the
+    // old get_meaning.py output
+    static std::string format(const std::string& word, const std::vector<Sense>& senses);
+
+    // Parses an API response body into senses; false if it is not the
+    // expected JSON shape
+    static bool parse_response(const std::string& body, std::vector<Sense>& senses, std::string* error = nullptr);
+    // Classifies a completed HTTP exchange (shared with the prefetcher)
+    static FetchResult interpret(long http_status, const std::string& body);
+    // `base_url` if set, else $DICT_API_URL, else DEFAULT_URL
+    static std::string resolve_base_url(const std::string& base_url);
+    // Shared transfer options; response bodies are appended to the
+    // std::string passed as CURLOPT_WRITEDATA
+    static void configure(CURL* handle, long timeout_ms);
+    // Full request URL for `word`, or "" if it cannot be escaped
+    static std::string url_for(CURL* handle, const std::string& base_url, const std::string& word);
+
+    // Prevent copying
+    DefinitionFetcher(const DefinitionFetcher&) = delete;
+    DefinitionFetcher& operator=(const DefinitionFetcher&) = delete;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "database.hpp"
+#include <functional>
+#include <string>
+
+// Outcome of a bulk definitions import
+struct ImportResult {
+    bool ok = false;        // file was readable and every batch committed
+    size_t rows = 0;        // rows written to the database
+    size_t skipped = 0;     // blank or malformed records
+    double seconds = 0;
+};
+
+// Called after each committed batch with rows so far and bytes consumed
+using ImportProgress = std::function<void(size_t rows, size_t bytes_read, size_t total_bytes)>;
+
+// Streams a word -> meaning file into the database in large transactions.
+// Files ending in .jsonl/.ndjson hold one {"word": ..., "meaning": ...}
+// object per line ("definition" is accepted for "meaning"); anything else is
+// read as CSV with the word in the first column and the meaning in the
+// second. A leading "word,meaning" header row is skipped.
+ImportResult import_definitions(DictionaryDB& db, const std::string& path,
+                                const ImportProgress& progress = nullptr,
+                                size_t batch_size = 50000);
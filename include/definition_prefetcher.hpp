@@ -0,0 +1,106 @@
+#pragma once
+
+#include "database.hpp"
+#include "definition_resolver.hpp"
+#include <curl/curl.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct PrefetchOptions {
+    size_t max_in_flight = 4;          // concurrent transfers
+    double requests_per_second = 5;    // token bucket refill rate
+    double burst = 5;                  // token bucket size
+    size_t queue_capacity = 1024;      // words waiting; more are dropped
+    long timeout_ms = 5000;            // per transfer
+    std::string base_url;              // see DefinitionFetcher::resolve_base_url
+};
+
+struct PrefetchStats {
+    size_t queued = 0;      // accepted by prefetch()
+    size_t skipped = 0;     // stored, known missing or being looked up when dequeued
+    size_t dropped = 0;     // queue was full
+    size_t fetched = 0;     // definitions written to the database
+    size_t not_found = 0;
+    size_t failed = 0;
+    size_t in_flight = 0;
+    size_t pending = 0;     // still queued
+    double latency_p50_ms = 0;
+    double latency_p99_ms = 0;
+    double latency_max_ms = 0;
+    double throughput = 0;  // completed transfers per second of activity
+};
+
+// Fills DictionaryDB in the background with definitions the user is likely
+// to ask for next (completions on screen, the word of the day, bookmarks).
+// One I/O thread drives all transfers through a curl multi handle, which
+// also keeps connections alive between them. Concurrency is capped at
+// max_in_flight and request starts are rate limited by a token bucket, so
+// a long candidate list never floods the upstream API.
+//
+// Each transfer holds the resolver's flight for its word, so a user lookup
+// of a word being prefetched waits for that transfer instead of starting
+// another, and a word the user is already looking up is not prefetched.
+class DefinitionPrefetcher {
+private:
+    // One transfer; reached from the easy handle through CURLOPT_PRIVATE
+    struct Transfer {
+        CURL* easy = nullptr;
+        std::string word;
+        std::unique_ptr<DefinitionResolver::Lease> lease;
+        std::string body;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    DictionaryDB& db;
+    DefinitionResolver& resolver;
+    PrefetchOptions options;
+    std::string base_url;
+    CURLM* multi;
+
+    std::mutex mutex;                   // guards everything below
+    std::condition_variable idle_cv;
+    std::deque<std::string> queue;
+    std::unordered_set<std::string> queued_words;  // queued or in flight
+    size_t in_flight = 0;
+    bool stopping = false;
+    PrefetchStats counters;
+    std::vector<double> latencies_ms;  // ring of recent completions
+    size_t latency_next = 0;
+    double active_seconds = 0;         // time with work queued or in flight
+
+    std::vector<std::unique_ptr<Transfer>> active;  // I/O thread only
+    std::thread io;
+
+    void io_loop();
+    // Starts transfers allowed by the concurrency cap and token bucket
+    void start_transfers(double& tokens);
+    void finish_transfer(CURL* easy, CURLcode code);
+    void record_latency(double ms);
+
+public:
+    // `resolver` must be the one that serves user lookups from `db`
+    DefinitionPrefetcher(DictionaryDB& db, DefinitionResolver& resolver,
+                         const PrefetchOptions& options = PrefetchOptions());
+    ~DefinitionPrefetcher();
+
+    // Queues words for background lookup and returns how many were added.
+    // Words are normalized as DefinitionResolver does and those already
+    // queued are ignored; words that are stored, known missing or being
+    // looked up by the time their turn comes are skipped without a request.
+    size_t prefetch(const std::vector<std::string>& words);
+
+    // Blocks until nothing is queued or in flight
+    void wait_idle();
+    PrefetchStats stats();
+
+    // Prevent copying
+    DefinitionPrefetcher(const DefinitionPrefetcher&) = delete;
+    DefinitionPrefetcher& operator=(const DefinitionPrefetcher&) = delete;
+};
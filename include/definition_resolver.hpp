@@ -0,0 +1,63 @@
+#pragma once
+
+#include "database.hpp"
+#include "definition_fetcher.hpp"
+#include "single_flight.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+
+// Where a resolved meaning came from
+struct Resolution {
+    enum class Source {
+        Database,  // stored (or cached) meaning
+        Fetched,   // fetched online just now and stored
+        NotFound,  // no definition anywhere (possibly remembered from earlier)
+        Error      // the online lookup failed; try again later
+    };
+
+    Source source = Source::Error;
+    std::string meaning;
+    std::string error;
+
+    bool found() const { return source == Source::Database || source == Source::Fetched; }
+};
+
+// Looks a word up in the database and falls back to the online API. Misses
+// go through a single-flight keyed by the normalized word, so concurrent
+// requests for the same uncached word cause one upstream fetch and one
+// database write; everyone waiting gets the same result. Fetch errors are
+// shared for a couple of seconds instead of being retried by each caller.
+class DefinitionResolver {
+private:
+    DictionaryDB& db;
+    DefinitionFetcher& fetcher;
+    SingleFlight<std::string, Resolution> flights;
+
+    Resolution fetch_and_store(const std::string& word);
+    static std::string trim(const std::string& word);
+
+public:
+    // Fetch errors are handed back for `failure_window` before a lookup
+    // tries the API again
+    DefinitionResolver(DictionaryDB& db, DefinitionFetcher& fetcher,
+                       std::chrono::steady_clock::duration failure_window = std::chrono::seconds(2));
+
+    // Tries the word as given (trimmed), then its normalized key
+    Resolution resolve(const std::string& word);
+
+    // Key used for storage and coalescing: trimmed and ASCII-lowercased
+    static std::string normalize(const std::string& word);
+
+    // For callers that run the online lookup themselves (the prefetcher):
+    // claims the flight for `key`, a normalize()d word, so resolve() calls
+    // for it wait for the lease instead of fetching again. nullptr if a
+    // lookup of the word is already running or failed moments ago.
+    using Lease = SingleFlight<std::string, Resolution>::Lease;
+    std::unique_ptr<Lease> lead(const std::string& key) { return flights.lead(key); }
+    // Stores the meaning, or remembers the miss, that a lookup of `key`
+    // returned; the result is what the lease should be completed with
+    Resolution store(const std::string& key, const FetchResult& fetched);
+
+    SingleFlight<std::string, Resolution>::Stats flight_stats() { return flights.stats(); }
+};
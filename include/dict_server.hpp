@@ -0,0 +1,111 @@
+#pragma once
+
+#include "query_engine.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Line protocol spoken by radix_dictd.
+//
+// Each request is one line, "COMMAND [ARG [LIMIT]]\n" (command names are
+// case-insensitive). Each response is a header line "OK <n>\n" followed by
+// exactly n data lines, or a single "ERR <reason>\n" line.
+//
+//   search <word>          1 line: "1" if the word is in the tree, else "0"
+//   prefix <p> [limit]     matching words in order (limit defaults to 100)
+//   suggest <word>         words within edit distance 2
+//   top [n]                "<word> <frequency>" lines, most used first
+//   meaning <word>         lines of the definition; ERR not_found / ERR fetch_failed
+//   insert <word>          no data lines
+//   remove <word>          no data lines; ERR not_found if absent
+//   quit                   the server closes the connection after replying
+//
+// Clients may pipeline: send many requests without waiting, responses come
+// back in request order.
+struct DictServerOptions {
+    std::string bind_address = "127.0.0.1";
+    int port = 7878;                    // TCP; 0 disables TCP
+    std::string unix_path;              // also listen on this Unix socket when set
+    size_t workers = 0;                 // 0 = one per hardware thread
+    size_t max_line = 4096;             // longer requests get ERR and a close
+    size_t max_input = 1 << 20;         // stop reading while this much is unparsed
+    size_t max_output = 4 << 20;        // stop executing while this much is unsent
+    int shutdown_grace_ms = 5000;       // time to flush replies on stop()
+};
+
+// epoll-based server: one I/O thread owns every socket and a pool of workers
+// executes requests against the QueryEngine. A connection hands its
+// complete request lines to one worker at a time, which keeps pipelined
+// replies in order. The I/O and work buffers are swapped rather than
+// reallocated, so a busy connection does no per-request buffer allocation.
+class DictServer {
+private:
+    struct Connection {
+        int fd;
+        std::string in;         // received, not yet handed to a worker (I/O thread)
+        std::string out;        // replies not yet written (I/O thread)
+        size_t out_sent = 0;
+        std::string work_in;    // requests a worker is executing
+        std::string work_out;   // their replies
+        bool busy = false;      // a worker owns work_in/work_out
+        bool quit = false;      // set by the worker on "quit"
+        bool peer_closed = false;
+        bool close_after_write = false;
+        uint32_t events = 0;    // current epoll interest; 0 = not registered
+    };
+
+    QueryEngine& engine;
+    DictServerOptions options;
+    int epoll_fd = -1;
+    int wake_fd = -1;           // eventfd: worker completions and stop()
+    std::vector<int> listen_fds;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::atomic<bool> stop_requested{false};
+    bool draining = false;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Connection*> jobs;
+    bool workers_stopping = false;
+    std::mutex done_mutex;
+    std::vector<Connection*> done;
+    std::vector<std::thread> workers;
+
+    bool listen_tcp();
+    bool listen_unix();
+    void accept_all(int listen_fd);
+    void on_readable(Connection& c);
+    void dispatch(Connection& c);
+    void flush(Connection& c);
+    void update_events(Connection& c);
+    // Closes now, or once the worker gives the connection back
+    void maybe_close(Connection& c);
+    void handle_completions();
+    void begin_drain();
+    bool drained() const;
+
+    void worker_loop();
+    void execute(Connection& c);
+    void execute_line(const char* begin, const char* end, Connection& c);
+
+public:
+    DictServer(QueryEngine& engine, const DictServerOptions& options = DictServerOptions());
+    ~DictServer();
+
+    // Opens the listening sockets and starts the workers; false on error
+    bool start();
+    // Serves until stop(), then finishes in-flight requests and returns
+    void run();
+    // Async-signal-safe
+    void stop();
+
+    // Prevent copying
+    DictServer(const DictServer&) = delete;
+    DictServer& operator=(const DictServer&) = delete;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal JSON reader/writer helpers for the small documents this app deals
+// with (JSONL records, dictionary API responses). Not a general-purpose
+// library: numbers are doubles and objects keep their members in order.
+namespace json {
+
+class Value {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value>> object;
+
+    bool is_null() const { return type == Type::Null; }
+    bool is_string() const { return type == Type::String; }
+    bool is_number() const { return type == Type::Number; }
+    bool is_array() const { return type == Type::Array; }
+    bool is_object() const { return type == Type::Object; }
+
+    // Member lookup; returns nullptr if this is not an object or has no such key
+    const Value* get(const std::string& key) const;
+    // String member or `fallback` when missing or not a string
+    std::string get_string(const std::string& key, const std::string& fallback = "") const;
+};
+
+// Parses one JSON document. Returns false (and fills `error` when given) on
+// malformed input or trailing garbage.
+bool parse(const std::string& text, Value& out, std::string* error = nullptr);
+
+// Appends `text` as a quoted JSON string literal
+void append_quoted(std::string& out, const std::string& text);
+
+} // namespace json
@@ -0,0 +1,153 @@
+#pragma once
+#include "radix_tree.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Read-only word list shared by every session in the process. Loaded once
+// per file; the words are never modified afterwards, so any number of
+// threads may query it without locking.
+class BaseDictionary {
+private:
+  RadixTree tree;
+  // (word, frequency) by descending frequency, for merged top-N queries
+  std::vector<std::pair<std::string, int>> ranking;
+
+public:
+  explicit BaseDictionary(const std::string &filename);
+
+  // Shared instance for `filename`, loaded on first use and released when
+  // the last session holding it goes away
+  static std::shared_ptr<const BaseDictionary>
+  load(const std::string &filename);
+
+  bool contains(const std::string &word) const { return tree.search(word); }
+  const RadixTree &words() const { return tree; }
+  const std::vector<std::pair<std::string, int>> &byFrequency() const {
+    return ranking;
+  }
+  int frequency(const std::string &word) const {
+    return tree.getWordInfo(word).frequency;
+  }
+};
+
+// One user's view of the dictionary: the shared base plus a private overlay
+// of added words and tombstones for removed base words. Queries merge both
+// layers, so a session costs memory in proportion to its own edits and
+// usage statistics rather than to the size of the dictionary. The overlay
+// is owned by one session and is not synchronised.
+class LayeredDictionary {
+private:
+  std::shared_ptr<const BaseDictionary> base;
+  RadixTree additions;                          // words not in the base
+  size_t addedWords = 0;
+  std::unordered_set<std::string> tombstones;   // base words removed here
+  std::unordered_map<std::string, WordInfo> wordStats;  // this user's usage
+
+  // Drops tombstoned words from results taken from the base
+  void dropRemoved(std::vector<std::string> &words) const;
+  // Reduces statistics in the pre-overlay format to this user's usage;
+  // false if they do not list every base word
+  bool migrateLegacyStats();
+
+public:
+  explicit LayeredDictionary(std::shared_ptr<const BaseDictionary> base);
+
+  // Same interface as RadixTree
+  void insert(const std::string &key);
+  bool search(const std::string &key) const;
+  void remove(const std::string &key);
+  void update(const std::string &oldKey, const std::string &newKey);
+  std::vector<std::string> starts_with(const std::string &prefix) const;
+  std::vector<std::string> suggest(const std::string &word,
+                                   int max_distance = 2) const;
+  void recordUsage(const std::string &word);
+  // Statistics files hold only this user's usage, under a version line.
+  // Files without it that list the whole dictionary come from before the
+  // overlay; they are trimmed to this user's usage and rewritten.
+  void loadStats(const std::string &filename);
+  void saveStats(const std::string &filename) const;
+  // Adds the file's words to the overlay
+  void loadWords(const std::string &filename);
+  // Frequencies are the base's plus this user's
+  std::vector<std::pair<std::string, int>> getTopNWords(int N) const;
+  WordInfo getWordInfo(const std::string &word) const;
+  // Calls fn(word, info) for every word, most frequent first, until it
+  // returns false. Only the words this user touched are sorted; the rest
+  // are read from the base ranking in place.
+  void forEachByFrequency(
+      const std::function<bool(const std::string &, const WordInfo &)> &fn)
+      const;
+
+  // Approximate heap footprint of the overlay alone
+  size_t memoryUsage() const;
+  size_t addedCount() const { return addedWords; }
+  size_t removedCount() const { return tombstones.size(); }
+  // A standalone tree holding the merged word list
+  RadixTree materialize() const;
+
+  // RadixTree::Cursor over both layers; invalidated by insert and remove
+  class Cursor {
+  private:
+    friend class LayeredDictionary;
+    const LayeredDictionary *owner;
+    RadixTree::Cursor baseCursor;
+    RadixTree::Cursor addedCursor;
+
+    Cursor(const LayeredDictionary *owner, RadixTree::Cursor base,
+           RadixTree::Cursor added)
+        : owner(owner), baseCursor(std::move(base)),
+          addedCursor(std::move(added)) {}
+
+  public:
+    const std::string &prefix() const { return baseCursor.prefix(); }
+    void push(char c) {
+      baseCursor.push(c);
+      addedCursor.push(c);
+    }
+    void pop() {
+      baseCursor.pop();
+      addedCursor.pop();
+    }
+    std::vector<std::string> complete(size_t limit) const;
+  };
+  Cursor cursor() const {
+    return Cursor(this, base->words().cursor(), additions.cursor());
+  }
+
+  // RadixTree::Iterator over both layers, skipping removed words;
+  // invalidated by insert and remove.
+  class Iterator {
+  private:
+    friend class LayeredDictionary;
+    const LayeredDictionary *owner;
+    RadixTree::Iterator baseIt;
+    RadixTree::Iterator addedIt;
+    std::string current;
+    bool onWord = false;
+    // Moving forward both layers sit on their first word >= current,
+    // moving back on their last word <= current; turning around re-seeks
+    bool forward = true;
+
+    Iterator(const LayeredDictionary *owner, RadixTree::Iterator base,
+             RadixTree::Iterator added)
+        : owner(owner), baseIt(std::move(base)), addedIt(std::move(added)) {}
+    void pick(bool lowest);
+    bool removed() const { return owner->tombstones.count(current) > 0; }
+
+  public:
+    bool valid() const { return onWord; }
+    const std::string &key() const { return current; }
+    void seek(const std::string &key);
+    void seekToLast();
+    void next();
+    void prev();
+  };
+  Iterator iterator() const {
+    return Iterator(this, base->words().iterator(), additions.iterator());
+  }
+};
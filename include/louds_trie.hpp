@@ -0,0 +1,74 @@
+#pragma once
+#include "radix_tree.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Plain bit vector with a rank directory (one counter per 512 bits) and
+// select by binary search over that directory.
+class BitVector {
+private:
+  std::vector<uint64_t> words;
+  std::vector<uint32_t> superRanks;
+  size_t nbits = 0;
+
+public:
+  void push_back(bool bit);
+  bool operator[](size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+  size_t size() const { return nbits; }
+  // Must be called after the last push_back and before rank/select
+  void buildIndex();
+  // Number of set bits in [0, i)
+  size_t rank1(size_t i) const;
+  size_t rank0(size_t i) const { return i - rank1(i); }
+  // Position of the k-th zero bit, k starting at 1
+  size_t select0(size_t k) const;
+  size_t memoryUsage() const;
+  void save(std::ostream &out) const;
+  bool load(std::istream &in);
+};
+
+// Static, read-only succinct trie using LOUDS (level-order unary degree
+// sequence). The shape costs about two bits per node; each node stores the
+// first byte of its incoming edge label, and longer (path-compressed) labels
+// keep their tail in one shared character array. Navigation is done with
+// rank/select on the bit vectors, so search and starts_with are O(k) rank
+// operations with no pointers at all.
+class LoudsTrie {
+private:
+  BitVector louds;    // "10" super-root, then 1^degree 0 per node, BFS order
+  BitVector terminal; // node ends a word
+  BitVector hasTail;  // incoming label is longer than one byte
+  std::vector<char> firstChar;
+  std::vector<char> tails;
+  std::vector<uint32_t> tailOffsets;
+  size_t numWords = 0;
+
+  // Children of `node` are the consecutive ids [first, first + count)
+  void children(size_t node, size_t &first, size_t &count) const;
+  size_t findChild(size_t node, char c) const;
+  // Appends the full incoming label of `node` to `out`
+  void appendLabel(size_t node, std::string &out) const;
+  size_t labelSize(size_t node) const;
+  const char *tailData(size_t node) const;
+  void collect_words(size_t node, std::string &prefix,
+                     std::vector<std::string> &words) const;
+
+public:
+  LoudsTrie();
+  static LoudsTrie build(const RadixTree &tree);
+  // Inserts every word into a mutable tree
+  void loadInto(RadixTree &tree) const;
+
+  bool search(const std::string &key) const;
+  std::vector<std::string> starts_with(const std::string &prefix) const;
+
+  size_t wordCount() const { return numWords; }
+  size_t nodeCount() const { return terminal.size(); }
+  size_t memoryUsage() const;
+
+  // Binary image; returns false on I/O error or a malformed file
+  bool save(const std::string &filename) const;
+  bool load(const std::string &filename);
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hot-path latency histograms and event counters.
+//
+// Each thread records into its own block of histograms with plain relaxed
+// stores, so timing an operation costs two clock reads and no shared
+// writes. On x86 the clock is the TSC (about half the cost of
+// steady_clock), converted to nanoseconds only when reporting. Blocks are
+// registered once per thread and merged only when a report is asked for;
+// a thread's totals are folded into a retired block when it exits.
+// Histograms are log-linear in clock ticks (16 sub-buckets per power of
+// two, so any reported percentile is within 1/16 of the true value), in
+// the spirit of HdrHistogram.
+//
+// Built with DICT_ENABLE_METRICS (the Makefile's METRICS=1, the default).
+// Without it METRIC_TIMER and METRIC_COUNT expand to nothing and report()
+// only says so.
+namespace metrics {
+
+// Timed operations; keep in step with the names in metrics.cpp
+enum class Timer {
+    TreeInsert,
+    TreeSearch,
+    TreeRemove,
+    TreeStartsWith,
+    TreeSuggest,
+    TreeTopN,
+    TreeLoadWords,
+    TreeLoadStats,
+    TreeSaveStats,
+    DbAddWord,
+    DbAddWords,
+    DbGetMeaning,
+    DbMarkMissing,
+    DbKnownMissing,
+    DbWordExists,
+    DbRecordSearch,
+    DbSearchHistory,
+    DbFlush,
+    DbDailyCounts,
+    DbSearchDefinitions,
+    DbWriteBatch,
+    Fetch,
+    Count
+};
+
+enum class Counter {
+    CacheHit,          // meaning served from the definition cache
+    CacheNegativeHit,  // remembered as missing
+    CacheMiss,         // went to the write queue or SQLite
+    FetchOk,
+    FetchNotFound,
+    FetchError,
+    Count
+};
+
+#ifdef DICT_ENABLE_METRICS
+
+// Timestamp in clock ticks; see nanos_per_tick() in metrics.cpp
+inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void record(Timer timer, uint64_t elapsed_ticks);
+void count(Counter counter, uint64_t n = 1);
+
+class ScopedTimer {
+private:
+    Timer timer;
+    uint64_t start;
+
+public:
+    explicit ScopedTimer(Timer timer) : timer(timer), start(ticks()) {}
+    ~ScopedTimer() { record(timer, ticks() - start); }
+
+    // Prevent copying
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Times the rest of the enclosing scope
+#define METRIC_TIMER(id) metrics::ScopedTimer metric_scope_timer_(metrics::Timer::id)
+#define METRIC_COUNT(id) metrics::count(metrics::Counter::id)
+
+#else
+
+#define METRIC_TIMER(id) ((void)0)
+#define METRIC_COUNT(id) ((void)0)
+
+#endif
+
+// Merged table of every thread's histograms and counters, one line per
+// operation that has run at least once
+std::string report();
+
+// Rewrites `path` with report() every `interval_seconds` (via a temporary
+// file and rename, so readers never see half a report) and once more when
+// destroyed
+class PeriodicDump {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    PeriodicDump(const std::string& path, unsigned interval_seconds);
+    ~PeriodicDump();
+
+    // From DICT_METRICS_DUMP (path) and DICT_METRICS_INTERVAL (seconds,
+    // default 60); nullptr if no path is set or metrics are compiled out
+    static std::unique_ptr<PeriodicDump> from_env();
+
+    // Prevent copying
+    PeriodicDump(const PeriodicDump&) = delete;
+    PeriodicDump& operator=(const PeriodicDump&) = delete;
+};
+
+} // namespace metrics
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+// Metaphone key of `word` (Lawrence Philips, 1990): consonant sounds only,
+// with silent letters dropped and letters that sound alike mapped to one
+// code, so "phonetic" and "fonetik" both give "FNTK" and "knowledge" and
+// "nollij" both give "NLJ". A leading vowel is kept as 'A'; '0' stands for
+// "th" and 'X' for "sh"/"ch". Case-insensitive; anything but ASCII letters
+// is ignored. Unlike Double Metaphone there is a single key per word and it
+// is not cut to four characters, so keys stay selective on large lists.
+std::string metaphone(const std::string &word);
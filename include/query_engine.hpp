@@ -0,0 +1,53 @@
+#pragma once
+
+#include "database.hpp"
+#include "definition_resolver.hpp"
+#include "radix_tree.hpp"
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Thread-safe facade over one RadixTree and the definition resolver, shared
+// by the non-interactive front ends (radix_dictd, batch mode). Lookups take
+// the tree lock shared and only edits take it exclusively; word statistics
+// have their own mutex so recording a search never blocks other lookups.
+// Where both are held the tree lock is taken first.
+class QueryEngine {
+private:
+    RadixTree& tree;
+    DictionaryDB& db;
+    DefinitionResolver& resolver;
+    mutable std::shared_mutex tree_mutex;  // tree structure
+    mutable std::mutex stats_mutex;        // tree word statistics and top_words
+
+    // The most frequent words, kept up to date as usage is recorded so `top`
+    // does not rank the whole statistics map on every request. Frequencies
+    // only grow, so a word outside this list can only enter it by passing
+    // its last entry.
+    static constexpr size_t TOP_CACHE = 100;
+    std::vector<std::pair<std::string, int>> top_words;
+
+    // Re-ranks `word` after its frequency changed; callers hold stats_mutex
+    void update_top(const std::string& word);
+    // Tops top_words back up to TOP_CACHE entries from the tree's statistics
+    // after a removal; callers hold both locks
+    void refill_top();
+
+public:
+    QueryEngine(RadixTree& tree, DictionaryDB& db, DefinitionResolver& resolver);
+
+    // Exact lookup; a hit counts towards the word's frequency
+    bool search(const std::string& word);
+    // Words starting with `prefix` in lexicographic order, at most `limit`
+    std::vector<std::string> prefix(const std::string& prefix, size_t limit = 100) const;
+    std::vector<std::string> suggest(const std::string& word, int max_distance = 2) const;
+    // Most used words; n <= TOP_CACHE is served without scanning the tree
+    std::vector<std::pair<std::string, int>> top(int n = 10) const;
+    // Stored or online definition; found meanings count as a search
+    Resolution meaning(const std::string& word);
+    void insert(const std::string& word);
+    // False if the word was not in the tree
+    bool remove(const std::string& word);
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// What a logged operation did; the numbers are part of the file format
+enum class QueryOp : uint8_t {
+    Insert = 1,
+    Remove = 2,
+    Search = 3,             // exact lookup in the tree
+    Suggest = 4,            // spelling suggestions for a missed search
+    Prefix = 5,             // every word with the prefix
+    Complete = 6,           // as-you-type completion, one keystroke
+    Top = 7,                // key is the number of words asked for
+    Meaning = 8,            // resolve and count as a search
+    Preview = 9,            // resolve without counting
+    AddWord = 10,           // insert with a user-supplied meaning
+    SearchDefinitions = 11  // reverse lookup, key is the query
+};
+
+const char* query_op_name(QueryOp op);
+
+struct QueryRecord {
+    QueryOp op = QueryOp::Search;
+    uint64_t timestamp_us = 0;  // wall clock when the operation started
+    uint64_t latency_us = 0;
+    std::string key;
+};
+
+// Append-only binary log of user operations, for replaying production
+// workloads with radix_replay. Records are buffered and written with one
+// write(2) once 64 KB have piled up, by a background thread within a
+// second of being appended, or on flush() and destruction. append() may be
+// called from any thread. Opening an existing log first cuts off a record
+// left half written by a crash, so the records appended after it can be
+// read back.
+//
+// Format (integers are unsigned LEB128 varints unless noted):
+//
+//   "RDXQLOG1"                      once, at the start of the file
+//   session:  u8 0, u64 start_us    (little endian) each time a log is opened
+//   record:   u8 op
+//             delta_us              zigzag; from the previous record's
+//                                   timestamp, or the session start
+//             latency_us
+//             key_length, key bytes
+class QueryLog {
+private:
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable flusher_cv;  // wakes the flusher to stop
+    std::string buffer;
+    uint64_t last_timestamp_us = 0;
+    bool stopping = false;
+    std::thread flusher;
+
+    void write_buffer();
+    void flush_loop();
+
+public:
+    explicit QueryLog(const std::string& path);
+    ~QueryLog();
+
+    bool is_open() const { return fd >= 0; }
+    void append(QueryOp op, const std::string& key, uint64_t timestamp_us, uint64_t latency_us);
+    void flush();
+
+    // Log named by $DICT_QUERY_LOG, or nullptr when unset
+    static std::unique_ptr<QueryLog> from_env();
+
+    // Logs one operation with its latency when it goes out of scope; does
+    // nothing if `log` is null
+    class Scope {
+    private:
+        QueryLog* log;
+        QueryOp op;
+        std::string key;
+        uint64_t timestamp_us = 0;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        Scope(QueryLog* log, QueryOp op, const std::string& key);
+        ~Scope();
+
+        // Prevent copying
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Prevent copying
+    QueryLog(const QueryLog&) = delete;
+    QueryLog& operator=(const QueryLog&) = delete;
+};
+
+// Reads a log written by QueryLog, session markers resolved. A record cut
+// short at the end of the file (a crash mid-write) ends the log quietly.
+class QueryLogReader {
+private:
+    std::string data;
+    size_t pos = 0;
+    uint64_t last_timestamp_us = 0;
+    bool valid = false;
+
+public:
+    // False (with a message on stderr) if the file cannot be read or is
+    // not a query log
+    bool open(const std::string& path);
+    bool next(QueryRecord& record);
+};
@@ -0,0 +1,265 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Radix tree mapping words to values. Children are kept sorted by their
+// first byte, so traversal is lexicographic, and every node counts the
+// values below it so a page of prefix results can skip whole subtrees
+// instead of walking them.
+template <typename V> class RadixMap {
+private:
+  struct Node {
+    std::string label; // edge label leading to this node
+    std::optional<V> value;
+    size_t count = 0; // values in this subtree, own included
+    std::vector<std::unique_ptr<Node>> children; // sorted by label[0]
+  };
+
+  Node root;
+
+  static size_t commonPrefix(const std::string &a, size_t from,
+                             const std::string &b) {
+    size_t i = 0;
+    while (from + i < a.size() && i < b.size() && a[from + i] == b[i])
+      ++i;
+    return i;
+  }
+
+  static typename std::vector<std::unique_ptr<Node>>::iterator
+  childFor(Node &node, char c) {
+    return std::lower_bound(
+        node.children.begin(), node.children.end(), c,
+        [](const std::unique_ptr<Node> &n, char ch) {
+          return (unsigned char)n->label[0] < (unsigned char)ch;
+        });
+  }
+
+  // Topmost node whose key starts with `prefix`, with that key in `path`;
+  // nullptr if no key has this prefix
+  const Node *findPrefix(const std::string &prefix, std::string &path) const {
+    const Node *node = &root;
+    size_t depth = 0;
+    path.clear();
+    while (depth < prefix.size()) {
+      auto it = childFor(const_cast<Node &>(*node), prefix[depth]);
+      if (it == node->children.end() || (*it)->label[0] != prefix[depth])
+        return nullptr;
+      const Node *child = it->get();
+      size_t common = commonPrefix(prefix, depth, child->label);
+      if (common < child->label.size() && depth + common < prefix.size())
+        return nullptr;
+      path += child->label;
+      depth += child->label.size();
+      node = child;
+    }
+    return node;
+  }
+
+  // Appends up to `limit` entries below `node` after skipping `skip`
+  template <typename Out>
+  static void collect(const Node &node, std::string &path, size_t &skip,
+                      size_t &limit, Out &out) {
+    if (limit == 0)
+      return;
+    if (node.value) {
+      if (skip > 0) {
+        --skip;
+      } else {
+        out.emplace_back(path, *node.value);
+        --limit;
+      }
+    }
+    for (auto &child : node.children) {
+      if (limit == 0)
+        return;
+      if (skip >= child->count) {
+        skip -= child->count;
+        continue;
+      }
+      path += child->label;
+      collect(*child, path, skip, limit, out);
+      path.resize(path.size() - child->label.size());
+    }
+  }
+
+  struct FuzzyState {
+    const std::string &word;
+    int max_distance;
+    std::vector<std::pair<int, std::string>> &matches;
+  };
+
+  // Levenshtein rows carried down the tree; a branch is abandoned as soon
+  // as every cell of its row exceeds the allowed distance
+  static void fuzzyWalk(const Node &node, std::string &path,
+                        const std::vector<int> &prevRow, FuzzyState &state) {
+    if (node.value && prevRow.back() <= state.max_distance)
+      state.matches.emplace_back(prevRow.back(), path);
+    for (auto &child : node.children) {
+      std::vector<int> row = prevRow, next(prevRow.size());
+      bool alive = true;
+      size_t added = 0;
+      for (char c : child->label) {
+        next[0] = row[0] + 1;
+        int best = next[0];
+        for (size_t j = 1; j < next.size(); ++j) {
+          next[j] = std::min({next[j - 1] + 1, row[j] + 1,
+                              row[j - 1] + (state.word[j - 1] == c ? 0 : 1)});
+          best = std::min(best, next[j]);
+        }
+        row.swap(next);
+        path.push_back(c);
+        ++added;
+        if (best > state.max_distance) {
+          alive = false;
+          break;
+        }
+      }
+      if (alive)
+        fuzzyWalk(*child, path, row, state);
+      path.resize(path.size() - added);
+    }
+  }
+
+public:
+  size_t size() const { return root.count; }
+  bool empty() const { return root.count == 0; }
+
+  // Sets the value for `key`; true if the key was new
+  bool insert_or_assign(const std::string &key, V value) {
+    std::vector<Node *> trail{&root};
+    Node *node = &root;
+    size_t depth = 0;
+    while (depth < key.size()) {
+      auto it = childFor(*node, key[depth]);
+      if (it == node->children.end() || (*it)->label[0] != key[depth]) {
+        auto leaf = std::make_unique<Node>();
+        leaf->label = key.substr(depth);
+        node = node->children.insert(it, std::move(leaf))->get();
+        trail.push_back(node);
+        depth = key.size();
+        break;
+      }
+      Node *child = it->get();
+      size_t common = commonPrefix(key, depth, child->label);
+      if (common < child->label.size()) {
+        // Split the edge at the divergence point
+        auto mid = std::make_unique<Node>();
+        mid->label = child->label.substr(0, common);
+        mid->count = child->count;
+        child->label.erase(0, common);
+        mid->children.push_back(std::move(*it));
+        *it = std::move(mid);
+        child = it->get();
+      }
+      node = child;
+      trail.push_back(node);
+      depth += common;
+    }
+    bool inserted = !node->value;
+    node->value = std::move(value);
+    if (inserted)
+      for (Node *n : trail)
+        n->count++;
+    return inserted;
+  }
+
+  const V *find(const std::string &key) const {
+    std::string path;
+    const Node *node = findPrefix(key, path);
+    if (!node || path.size() != key.size() || !node->value)
+      return nullptr;
+    return &*node->value;
+  }
+
+  V *find(const std::string &key) {
+    return const_cast<V *>(std::as_const(*this).find(key));
+  }
+
+  bool contains(const std::string &key) const { return find(key) != nullptr; }
+
+  // True if the key was present
+  bool erase(const std::string &key) {
+    std::vector<std::pair<Node *, size_t>> trail; // node, index in parent
+    Node *node = &root;
+    size_t depth = 0;
+    while (depth < key.size()) {
+      auto it = childFor(*node, key[depth]);
+      if (it == node->children.end() || (*it)->label[0] != key[depth])
+        return false;
+      Node *child = it->get();
+      if (key.compare(depth, child->label.size(), child->label) != 0)
+        return false;
+      trail.emplace_back(node, it - node->children.begin());
+      node = child;
+      depth += child->label.size();
+    }
+    if (!node->value)
+      return false;
+    node->value.reset();
+    root.count--;
+    for (auto &[parent, index] : trail)
+      parent->children[index]->count--;
+
+    // Prune the emptied leaf, then merge a valueless single-child node
+    // into its child so edges stay maximal
+    if (!trail.empty()) {
+      auto [parent, index] = trail.back();
+      if (node->children.empty()) {
+        parent->children.erase(parent->children.begin() + index);
+        node = parent;
+        trail.pop_back();
+        if (trail.empty())
+          return true;
+        std::tie(parent, index) = trail.back();
+      }
+      if (!node->value && node->children.size() == 1 && node != &root) {
+        std::unique_ptr<Node> child = std::move(node->children[0]);
+        child->label = node->label + child->label;
+        parent->children[index] = std::move(child);
+      }
+    }
+    return true;
+  }
+
+  // Number of keys starting with `prefix`
+  size_t countPrefix(const std::string &prefix) const {
+    std::string path;
+    const Node *node = findPrefix(prefix, path);
+    return node ? node->count : 0;
+  }
+
+  // Keys starting with `prefix` in lexicographic order, skipping `offset`
+  // and returning at most `limit`
+  std::vector<std::pair<std::string, V>>
+  listPrefix(const std::string &prefix, size_t offset = 0,
+             size_t limit = (size_t)-1) const {
+    std::vector<std::pair<std::string, V>> out;
+    std::string path;
+    const Node *node = findPrefix(prefix, path);
+    if (node)
+      collect(*node, path, offset, limit, out);
+    return out;
+  }
+
+  // Keys within `max_distance` edits of `word`, closest first
+  std::vector<std::string> fuzzy(const std::string &word, int max_distance,
+                                 size_t limit = (size_t)-1) const {
+    std::vector<std::pair<int, std::string>> matches;
+    FuzzyState state{word, max_distance, matches};
+    std::vector<int> row(word.size() + 1);
+    for (size_t j = 0; j < row.size(); ++j)
+      row[j] = j;
+    std::string path;
+    fuzzyWalk(root, path, row, state);
+    std::sort(matches.begin(), matches.end());
+    std::vector<std::string> words;
+    for (size_t i = 0; i < matches.size() && i < limit; ++i)
+      words.push_back(std::move(matches[i].second));
+    return words;
+  }
+};
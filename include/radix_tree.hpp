@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <ctime>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -11,6 +12,8 @@
 // Node of Radix Tree
 struct RadixTreeNode {
   bool isEndOfWord = false;
+  RadixTreeNode *parent = nullptr; // to spell a word back from its node
+  RadixTreeNode *nextAlike = nullptr; // next word with the same phonetic key
   // Edge label -> child node
   std::unordered_map<std::string, std::shared_ptr<RadixTreeNode>> children;
 };
@@ -25,6 +28,12 @@ class RadixTree {
 private:
   std::shared_ptr<RadixTreeNode> root;
   std::unordered_map<std::string, WordInfo> wordStats;
+  // Hash of a metaphone key -> first word node with that key; the rest
+  // follow through nextAlike. Kept in step by insert and remove, so
+  // sound-alike suggestions are one key computation and one probe instead
+  // of a scan. Holds neither keys nor words: a chain may mix keys whose
+  // hashes collide, so the probe re-checks each word's key.
+  std::unordered_map<size_t, RadixTreeNode *> phonetic;
 
   void collect_words(const std::shared_ptr<RadixTreeNode> &node,
                      const std::string &prefix,
@@ -32,6 +41,9 @@ private:
   bool removeHelper(const std::shared_ptr<RadixTreeNode> &node,
                     const std::string &key, size_t depth);
   size_t commonPrefix(const std::string &s1, const std::string &s2) const;
+  void indexPhonetic(const std::string &word, RadixTreeNode *node);
+  void unindexPhonetic(const std::string &word, RadixTreeNode *node);
+  static std::string spell(const RadixTreeNode *node);
 
 public:
   RadixTree();
@@ -41,9 +53,16 @@ public:
   void remove(const std::string &key);
   void update(const std::string &oldKey, const std::string &newKey);
   std::vector<std::string> starts_with(const std::string &prefix) const;
-  // Suggestions (simple edit-distance based brute force)
+  // Suggestions: words within `max_distance` edits (brute force) plus
+  // words that sound the same (phonetic index), most frequent first
   std::vector<std::string> suggest(const std::string &word,
                                    int max_distance = 2) const;
+  // suggest() in two steps, for callers that guard the word structure and
+  // the statistics with different locks: candidates() reads only the
+  // former and rankByFrequency() only the latter
+  std::vector<std::string> candidates(const std::string &word,
+                                      int max_distance = 2) const;
+  void rankByFrequency(std::vector<std::string> &words) const;
   // Statistics
   void recordUsage(const std::string &word);
   void loadStats(const std::string &filename);
@@ -52,4 +71,72 @@ public:
   void loadWords(const std::string &filename);
   // Analytics
   std::vector<std::pair<std::string, int>> getTopNWords(int N) const;
+  WordInfo getWordInfo(const std::string &word) const;
+  // Approximate heap footprint of nodes, edge labels and statistics
+  size_t memoryUsage() const;
+
+  // Incremental prefix walk for as-you-type completion: push() consumes
+  // one more character from where the previous one stopped instead of
+  // walking from the root again, pop() undoes it. Holds raw node pointers,
+  // so any insert or remove on the tree invalidates it.
+  class Cursor {
+  private:
+    friend class RadixTree;
+    struct State {
+      const RadixTreeNode *node;   // nullptr once the prefix left the tree
+      const RadixTreeNode *target; // child being entered mid-edge, or nullptr
+      const std::string *label;    // that child's edge label
+      size_t offset;               // characters of `label` matched
+    };
+    std::vector<State> states;
+    std::string text;
+
+    explicit Cursor(const RadixTreeNode *root);
+
+  public:
+    const std::string &prefix() const { return text; }
+    // False if no word starts with prefix()
+    bool valid() const { return states.back().node != nullptr; }
+    bool push(char c);
+    void pop();
+    // Up to `limit` words starting with prefix(), in lexicographic order
+    std::vector<std::string> complete(size_t limit) const;
+  };
+  Cursor cursor() const { return Cursor(root.get()); }
+
+  // Bidirectional walk over the words in lexicographic order, for paging
+  // through a large result set without collecting it: seek() lands on the
+  // first word not less than a key and next()/prev() step one word, at a
+  // cost that depends on the depth and fan-out of the tree, not on how
+  // many words there are. Invalidated by insert and remove, like Cursor.
+  class Iterator {
+  private:
+    friend class RadixTree;
+    using Edge = std::pair<const std::string, std::shared_ptr<RadixTreeNode>>;
+    struct Frame {
+      const RadixTreeNode *node;
+      std::vector<const Edge *> edges; // node's children, sorted by label
+      int index;                       // edge being visited, -1 for node
+    };
+    const RadixTreeNode *root;
+    std::vector<Frame> stack; // root to current node; empty when not valid
+    std::string text;
+
+    explicit Iterator(const RadixTreeNode *root) : root(root) {}
+    static Frame frameFor(const RadixTreeNode *node);
+    void descend();
+    void ascend();
+    bool advance();
+    bool retreat();
+    void reset();
+
+  public:
+    bool valid() const { return !stack.empty(); }
+    const std::string &key() const { return text; }
+    void seek(const std::string &key);
+    void seekToLast();
+    void next();
+    void prev();
+  };
+  Iterator iterator() const { return Iterator(root.get()); }
 };
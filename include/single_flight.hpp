@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Collapses concurrent calls for the same key into one. The first caller
+// for a key (the leader) runs the work; callers that arrive while it is
+// running wait on a shared future and get a copy of the same result.
+//
+// Results for which `is_failure` returns true are remembered for
+// `failure_window` after they complete, so a burst of requests for a key
+// whose upstream just failed gets the failure back instead of retrying.
+// Successful results are not kept; caching them is the caller's job.
+//
+// Work that finishes somewhere else (an event loop) can take the leader's
+// place with lead() and hand its result over through the returned Lease.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Failure {
+        Value value;
+        Clock::time_point expires;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<Key, std::shared_future<Value>, Hash> in_flight;
+    std::unordered_map<Key, Failure, Hash> failures;
+    std::function<bool(const Value&)> is_failure;
+    Clock::duration failure_window;
+    size_t leaders = 0;
+    size_t followers = 0;
+    size_t failure_hits = 0;
+
+    // Remembers a failed `value` and releases `key` to the next caller
+    void finish(const Key& key, std::promise<Value>& promise, const Value& value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (is_failure && is_failure(value)) {
+                auto now = Clock::now();
+                if (failures.size() >= 1024) {
+                    // Expired entries are otherwise only dropped when their key comes back
+                    for (auto it = failures.begin(); it != failures.end();) {
+                        it = it->second.expires <= now ? failures.erase(it) : std::next(it);
+                    }
+                }
+                failures[key] = Failure{value, now + failure_window};
+            }
+            in_flight.erase(key);
+        }
+        promise.set_value(value);
+    }
+
+public:
+    struct Stats {
+        size_t leaders = 0;       // calls that ran the work
+        size_t followers = 0;     // calls that shared a running call's result
+        size_t failure_hits = 0;  // calls answered from the failure window
+    };
+
+    explicit SingleFlight(std::function<bool(const Value&)> is_failure = nullptr,
+                          Clock::duration failure_window = std::chrono::seconds(2))
+        : is_failure(std::move(is_failure)), failure_window(failure_window) {}
+
+    // Returns the result of `work()` for `key`, running it at most once
+    // for all callers that overlap with it. If `work()` throws, every
+    // overlapping caller gets the exception and nothing is remembered.
+    template <typename Work>
+    Value run(const Key& key, Work&& work) {
+        std::promise<Value> promise;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto failed = failures.find(key);
+            if (failed != failures.end()) {
+                if (Clock::now() < failed->second.expires) {
+                    ++failure_hits;
+                    return failed->second.value;
+                }
+                failures.erase(failed);
+            }
+
+            auto running = in_flight.find(key);
+            if (running != in_flight.end()) {
+                ++followers;
+                std::shared_future<Value> result = running->second;
+                lock.unlock();
+                return result.get();
+            }
+            in_flight.emplace(key, promise.get_future().share());
+            ++leaders;
+        }
+
+        Value value = [&] {
+            try {
+                return work();
+            } catch (...) {
+                // Waiters get the exception too; the next call runs the work again
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    in_flight.erase(key);
+                }
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+        }();
+        finish(key, promise, value);
+        return value;
+    }
+
+    // A key claimed by lead(). Callers of run() for it wait until complete()
+    // and get its value; a lease destroyed without completing hands them
+    // std::future_error (broken_promise) instead.
+    class Lease {
+    private:
+        SingleFlight& owner;
+        Key key;
+        std::promise<Value> promise;
+        bool done = false;
+
+    public:
+        Lease(SingleFlight& owner, const Key& key, std::promise<Value> promise)
+            : owner(owner), key(key), promise(std::move(promise)) {}
+        ~Lease() {
+            if (!done) {
+                std::lock_guard<std::mutex> lock(owner.mutex);
+                owner.in_flight.erase(key);
+            }
+        }
+
+        const Key& get_key() const { return key; }
+        void complete(const Value& value) {
+            if (!done) {
+                done = true;
+                owner.finish(key, promise, value);
+            }
+        }
+
+        // Prevent copying
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+    };
+
+    // Non-blocking form of run() for work finished elsewhere: makes the
+    // caller the leader for `key`, or returns nullptr if a call for it is
+    // running or its failure is still remembered
+    std::unique_ptr<Lease> lead(const Key& key) {
+        std::promise<Value> promise;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto failed = failures.find(key);
+        if (failed != failures.end()) {
+            if (Clock::now() < failed->second.expires) {
+                ++failure_hits;
+                return nullptr;
+            }
+            failures.erase(failed);
+        }
+        if (in_flight.count(key)) {
+            return nullptr;
+        }
+        in_flight.emplace(key, promise.get_future().share());
+        ++leaders;
+        return std::make_unique<Lease>(*this, key, std::move(promise));
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Stats{leaders, followers, failure_hits};
+    }
+
+    // Prevent copying
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "layered_dictionary.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportFormat {
+    CSV,      // Word,Frequency,LastUsed
+    JSONL,    // {"word":...,"frequency":...,"last_used":...}
+    Columnar  // binary, see StatsExporter
+};
+
+enum class ExportOrder {
+    Lexicographic,
+    Frequency  // most used first
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::CSV;
+    ExportOrder order = ExportOrder::Lexicographic;
+    size_t threads = 0;        // formatting workers, 0 = one per hardware thread
+    size_t chunk_rows = 8192;  // rows per chunk; each chunk is one write(2)
+};
+
+struct ExportStats {
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;
+};
+
+// Writes every word with its full WordInfo. Words are read from the
+// dictionary on the calling thread, in order, and handed out in chunks to
+// a pool of workers that look up their statistics and format them into
+// one buffer per chunk; the calling thread writes finished chunks in
+// order, so formatting overlaps with reading and writing. The dictionary
+// must not change during the export. Output goes to `path`.tmp, which is
+// renamed over `path` once complete.
+//
+// Last-used times are UTC ISO 8601 ("2024-05-01T09:30:00Z"), empty in CSV
+// and null in JSONL for words never used.
+//
+// The columnar format is a magic string followed by blocks, one per chunk,
+// in host byte order:
+//
+//   "RDXSTAT1"
+//   block:  u32 rows
+//           u32 word_length[rows]
+//           char words[sum of word_length]   (no separators)
+//           i32 frequency[rows]
+//           i64 last_access[rows]            (seconds since the epoch)
+//   ...
+//   u32 0                                    (end of file)
+class StatsExporter {
+private:
+    struct Row {
+        std::string word;
+        WordInfo info;
+    };
+
+    struct Chunk {
+        std::vector<Row> rows;
+        std::string out;
+        bool formatted = false;
+    };
+
+    ExportOptions options;
+    const LayeredDictionary* dict = nullptr;
+    bool lookup_info = false;  // rows arrive without WordInfo; workers fill it in
+    int fd = -1;
+    bool failed = false;
+    ExportStats stats;
+
+    std::mutex mutex;
+    std::condition_variable work_cv;    // chunks waiting for a worker
+    std::condition_variable done_cv;    // a chunk finished formatting
+    std::deque<std::shared_ptr<Chunk>> inflight;  // in output order
+    std::deque<std::shared_ptr<Chunk>> todo;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void worker();
+    void format(Chunk& chunk) const;
+    void submit(std::vector<Row> rows);
+    // Writes finished chunks from the front; with `all`, waits for every one
+    void drain(bool all);
+    bool write_all(const std::string& data);
+
+public:
+    explicit StatsExporter(const ExportOptions& options = ExportOptions());
+
+    // False (with a message on stderr) if the file could not be written
+    bool run(const LayeredDictionary& dict, const std::string& path, ExportStats* result = nullptr);
+
+    // Prevent copying
+    StatsExporter(const StatsExporter&) = delete;
+    StatsExporter& operator=(const StatsExporter&) = delete;
+};
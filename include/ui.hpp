@@ -1,36 +1,126 @@
 #pragma once
 
 #include <ncurses.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 
+// Rows for the browse pane, read a screenful at a time so the cost of a
+// page does not depend on how many rows the source holds. Rows are keys
+// in sorted order and the pane remembers its position by key.
+class ResultSource {
+public:
+    virtual ~ResultSource() = default;
+    // Up to `count` rows starting at the first one >= `key`
+    virtual std::vector<std::string> rows_from(const std::string& key, size_t count) = 0;
+    // Up to `count` rows that come before `key`, in order
+    virtual std::vector<std::string> rows_before(const std::string& key, size_t count) = 0;
+    // The last `count` rows
+    virtual std::vector<std::string> last_rows(size_t count) = 0;
+};
+
 class UI {
 private:
+    // Lookups run on a worker thread so the input loop never blocks on the
+    // network. Enter queues a lookup whose result is always shown; pausing
+    // while typing requests a one-line preview, and a newer keystroke makes
+    // any queued or in-flight preview stale (its result is dropped).
+    struct LookupRequest {
+        uint64_t generation;
+        std::string query;
+        bool preview;
+    };
+    struct LookupResult {
+        uint64_t generation;
+        std::string query;
+        bool preview;
+        std::vector<std::string> lines;
+    };
+
     WINDOW* main_win;
     WINDOW* input_win;
-    WINDOW* result_win;
+    WINDOW* hint_win;   // completions and the preview, above the input line
     
     int max_y, max_x;
     std::string input_buffer;
     std::vector<std::string> search_history;
+    std::vector<std::string> completions;
+    bool running = true;
+
+    static constexpr int POLL_MS = 50;
+    static constexpr int DEBOUNCE_MS = 250;
+    static constexpr size_t MAX_COMPLETIONS = 8;
+    uint64_t generation = 0;        // bumped on every edit of input_buffer
+    std::chrono::steady_clock::time_point last_edit;
+    bool preview_requested = true;
+
+    std::thread lookup_thread;
+    std::mutex lookup_mutex;
+    std::condition_variable lookup_cv;
+    std::deque<LookupRequest> lookups;
+    bool has_preview = false;
+    LookupRequest preview;          // latest preview request, replaces older ones
+    std::deque<LookupResult> lookup_results;
+    bool lookup_stop = false;
+    uint64_t current_generation = 0;  // shared copy of `generation`
+
+    // Browse pane (/p): takes over main_win until closed
+    std::unique_ptr<ResultSource> browse;
+    WINDOW* browse_saved = nullptr;       // main_win as it was before
+    std::string browse_prefix;
+    std::vector<std::string> browse_rows;   // rows on screen, top first
+    std::vector<std::string> browse_lines;  // what each line of main_win shows
     
     void draw_borders();
     void draw_header();
     void draw_footer(const std::string& status);
     void process_input(int ch);
+    // Re-reads completions for input_buffer and redraws the input and hint lines
+    void input_changed();
+    void draw_input();
+    void draw_hints(const std::string& preview_line = "");
+    void request_lookup(const std::string& query, bool preview);
+    void show_lookup_results();
+    void lookup_loop();
+    void stop_lookups();
+    void quit();
+    void open_browse(const std::string& prefix);
+    void close_browse();
+    void browse_key(int ch);
+    // Puts `rows` on screen, redrawing only the lines that changed
+    void show_rows(std::vector<std::string> rows);
     
 public:
     UI();
-    ~UI();
+    virtual ~UI();
     
     // Main UI loop
     void run();
     
     // Callbacks (to be implemented in main.cpp)
+    // Called on the lookup thread
     virtual std::vector<std::string> on_search(const std::string& query) { return {}; }
+    // Called on the lookup thread; a short definition for the hint line,
+    // without counting as a search
+    virtual std::string on_preview(const std::string& word) { return ""; }
+    // Words to offer while `input` is being typed; called on every edit
+    virtual std::vector<std::string> on_complete(const std::string& input, size_t limit) { return {}; }
+    // Words starting with `prefix`, for the browse pane; nullptr if none
+    virtual std::unique_ptr<ResultSource> on_browse(const std::string& prefix) { return nullptr; }
     virtual bool on_add_word(const std::string& word, const std::string& meaning) { return false; }
+    // Reverse lookup: lines describing words whose meaning matches the query
+    virtual std::vector<std::string> on_search_definitions(const std::string& query) { return {}; }
     virtual std::string get_word_of_the_day() { return ""; }
+    // Latency and counter report for /metrics
+    virtual std::string on_metrics() { return ""; }
+    // Called right before the app exits (pending writes should be flushed)
+    virtual void on_quit() {}
     
     // New method for add word dialog
     void show_add_word_dialog() {
@@ -1,30 +1,47 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <openssl/sha.h>
+#include <sqlite3.h>
 
+// Accounts live in an SQLite table (users/users.db) keyed by username, so
+// lookups go through the primary-key index instead of loading every
+// account up front, and each signup or removal is a single-row
+// transaction. WAL mode and a busy timeout let several radix_dict
+// processes share the store. A legacy users/.users file is imported on
+// first start and renamed to .users.migrated.
 class UserManager {
 private:
-    std::string usersFile;
-    std::unordered_map<std::string, std::string> users;
+    std::string usersDb;
+    std::string legacyFile;
+    sqlite3* db = nullptr;
+    sqlite3_stmt* findStmt = nullptr;
+    sqlite3_stmt* insertStmt = nullptr;
+    sqlite3_stmt* deleteStmt = nullptr;
     std::string currentUser;
     std::string userDir;
 
     std::string hashPassword(const std::string& password);
-    void loadUsers();
-    void saveUsers();
+    bool openStore();
+    void migrateLegacyFile();
+    // Stored hash for `username`; false if there is no such user
+    bool findUser(const std::string& username, std::string& hash) const;
 
 public:
     UserManager();
+    ~UserManager();
     bool createUser(const std::string& username, const std::string& password);
     bool authenticate(const std::string& username, const std::string& password);
     bool removeUser(const std::string& username);
     std::string getCurrentUser() const;
     std::string getUserDir() const;
     bool userExists(const std::string& username) const;
+
+    // Prevent copying
+    UserManager(const UserManager&) = delete;
+    UserManager& operator=(const UserManager&) = delete;
 };
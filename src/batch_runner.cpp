@@ -0,0 +1,313 @@
+#include "../include/batch_runner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void append_number(std::string& out, double value) {
+    char buf[32];
+    if (std::floor(value) == value && std::fabs(value) < 1e15) {
+        std::snprintf(buf, sizeof(buf), "%.0f", value);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.17g", value);
+    }
+    out += buf;
+}
+
+void append_words(std::string& out, const std::vector<std::string>& words) {
+    out += ",\"words\":[";
+    for (size_t i = 0; i < words.size(); ++i) {
+        if (i) {
+            out.push_back(',');
+        }
+        json::append_quoted(out, words[i]);
+    }
+    out.push_back(']');
+}
+
+// Operations on the same key go to the same shard
+const std::string& key_of(const json::Value& request) {
+    static const std::string none;
+    const json::Value* key = request.get("word");
+    if (!key || !key->is_string()) {
+        key = request.get("prefix");
+    }
+    return key && key->is_string() ? key->string : none;
+}
+
+double percentile(const std::vector<float>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(QueryEngine& engine, const BatchOptions& options)
+    : engine(engine), options(options) {
+    if (this->options.threads == 0) {
+        this->options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->options.batch_size = std::max<size_t>(1, this->options.batch_size);
+    this->options.window = std::max(this->options.window, this->options.batch_size * this->options.threads);
+}
+
+bool BatchRunner::execute(const Operation& op, std::string& out, float& micros) {
+    out.clear();
+    out += "{\"line\":";
+    append_number(out, static_cast<double>(op.line));
+    if (!op.error.empty()) {
+        out += ",\"ok\":false,\"error\":";
+        json::append_quoted(out, op.error);
+        out += "}\n";
+        return false;
+    }
+
+    const json::Value* id = op.request.get("id");
+    if (id && id->is_string()) {
+        out += ",\"id\":";
+        json::append_quoted(out, id->string);
+    } else if (id && id->is_number()) {
+        out += ",\"id\":";
+        append_number(out, id->number);
+    }
+    std::string name = op.request.get_string("op");
+    out += ",\"op\":";
+    json::append_quoted(out, name);
+
+    const std::string& key = key_of(op.request);
+    std::string error;
+    auto start = Clock::now();
+    if (key.empty() && (name == "search" || name == "suggest" || name == "meaning" || name == "insert")) {
+        error = "missing word";
+    } else if (name == "search") {
+        bool found = engine.search(key);
+        out += found ? ",\"ok\":true,\"found\":true" : ",\"ok\":true,\"found\":false";
+    } else if (name == "prefix") {
+        size_t limit = 100;
+        const json::Value* value = op.request.get("limit");
+        if (value && value->is_number() && value->number >= 0) {
+            limit = static_cast<size_t>(value->number);
+        }
+        std::vector<std::string> words = engine.prefix(key, limit);
+        out += ",\"ok\":true";
+        append_words(out, words);
+    } else if (name == "suggest") {
+        std::vector<std::string> words = engine.suggest(key);
+        out += ",\"ok\":true";
+        append_words(out, words);
+    } else if (name == "meaning") {
+        Resolution r = engine.meaning(key);
+        if (r.found()) {
+            out += r.source == Resolution::Source::Fetched ? ",\"ok\":true,\"source\":\"fetched\""
+                                                           : ",\"ok\":true,\"source\":\"database\"";
+            out += ",\"meaning\":";
+            json::append_quoted(out, r.meaning);
+        } else if (r.source == Resolution::Source::NotFound) {
+            error = "not_found";
+        } else {
+            error = "fetch_failed: " + r.error;
+        }
+    } else if (name == "insert") {
+        engine.insert(key);
+        out += ",\"ok\":true";
+    } else {
+        error = "unknown op";
+    }
+    micros = std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+
+    if (!error.empty()) {
+        out += ",\"ok\":false,\"error\":";
+        json::append_quoted(out, error);
+    }
+    char timing[32];
+    std::snprintf(timing, sizeof(timing), ",\"us\":%.1f}\n", micros);
+    out += timing;
+    return error.empty();
+}
+
+void BatchRunner::worker_loop(Shard& shard) {
+    struct Result {
+        uint64_t seq;
+        std::string line;
+        float micros;
+        bool ok;
+    };
+    std::vector<Result> finished;
+    while (true) {
+        std::vector<Operation> batch;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.cv.wait(lock, [&] { return shard.closed || !shard.batches.empty(); });
+            if (shard.batches.empty()) {
+                return;
+            }
+            batch = std::move(shard.batches.front());
+            shard.batches.pop_front();
+        }
+
+        finished.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            finished[i].seq = batch[i].seq;
+            finished[i].micros = 0;
+            finished[i].ok = execute(batch[i], finished[i].line, finished[i].micros);
+        }
+
+        // Publish the whole batch under one lock
+        std::lock_guard<std::mutex> lock(results_mutex);
+        for (auto& r : finished) {
+            size_t slot = r.seq % options.window;
+            results[slot].swap(r.line);
+            latencies[slot] = r.micros;
+            states[slot] = r.ok ? Done : Failed;
+        }
+        results_cv.notify_all();
+    }
+}
+
+void BatchRunner::writer_loop(std::ostream& out, std::vector<float>& all_latencies, uint64_t& errors) {
+    std::string buffer;
+    buffer.reserve(options.flush_bytes + 4096);
+    std::unique_lock<std::mutex> lock(results_mutex);
+    while (true) {
+        size_t slot = next_to_write % options.window;
+        if (states[slot] != Empty) {
+            buffer += results[slot];
+            all_latencies.push_back(latencies[slot]);
+            errors += states[slot] == Failed;
+            states[slot] = Empty;
+            ++next_to_write;
+            if (buffer.size() >= options.flush_bytes) {
+                results_cv.notify_all();  // the reader may be waiting for window space
+                lock.unlock();
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+                lock.lock();
+            }
+            continue;
+        }
+        if (input_done && next_to_write > total) {
+            break;
+        }
+        results_cv.notify_all();
+        results_cv.wait(lock);
+    }
+    lock.unlock();
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+}
+
+BatchStats BatchRunner::run(std::istream& in, std::ostream& out) {
+    size_t threads = options.threads;
+    results.assign(options.window, std::string());
+    states.assign(options.window, Empty);
+    latencies.assign(options.window, 0);
+    next_to_write = 1;
+    total = 0;
+    input_done = false;
+
+    auto start = Clock::now();
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&BatchRunner::worker_loop, this, std::ref(*shards[i]));
+    }
+    std::vector<float> all_latencies;
+    uint64_t errors = 0;
+    std::thread writer(&BatchRunner::writer_loop, this, std::ref(out), std::ref(all_latencies), std::ref(errors));
+
+    std::vector<std::vector<Operation>> pending(threads);
+    auto hand_off = [&](size_t i) {
+        if (pending[i].empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            shards[i]->batches.push_back(std::move(pending[i]));
+        }
+        shards[i]->cv.notify_one();
+        pending[i].clear();
+        pending[i].reserve(options.batch_size);
+    };
+
+    std::hash<std::string> hasher;
+    std::string line;
+    uint64_t line_number = 0;
+    uint64_t seq = 0;
+    uint64_t window_end = options.window;  // last known next_to_write + window
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        ++seq;
+        if (seq >= window_end) {
+            // Partial batches may hold the line the writer is waiting for
+            for (size_t i = 0; i < threads; ++i) {
+                hand_off(i);
+            }
+            std::unique_lock<std::mutex> lock(results_mutex);
+            results_cv.wait(lock, [&] { return seq < next_to_write + options.window; });
+            window_end = next_to_write + options.window;
+        }
+
+        Operation op;
+        op.seq = seq;
+        op.line = line_number;
+        size_t shard = 0;
+        if (json::parse(line, op.request, &op.error)) {
+            op.error.clear();
+            if (!op.request.is_object()) {
+                op.error = "expected a JSON object";
+            } else {
+                shard = hasher(key_of(op.request)) % threads;
+            }
+        } else {
+            op.error = "malformed JSON: " + op.error;
+        }
+        pending[shard].push_back(std::move(op));
+        if (pending[shard].size() >= options.batch_size) {
+            hand_off(shard);
+        }
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        hand_off(i);
+        std::lock_guard<std::mutex> lock(shards[i]->mutex);
+        shards[i]->closed = true;
+        shards[i]->cv.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        total = seq;
+        input_done = true;
+        results_cv.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    writer.join();
+
+    BatchStats stats;
+    stats.operations = seq;
+    stats.errors = errors;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(all_latencies.begin(), all_latencies.end());
+    stats.p50_us = percentile(all_latencies, 0.50);
+    stats.p99_us = percentile(all_latencies, 0.99);
+    stats.max_us = all_latencies.empty() ? 0 : all_latencies.back();
+    return stats;
+}
@@ -0,0 +1,204 @@
+#include "../include/bookmark_store.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+BookmarkStore::BookmarkStore(const BookmarkStoreOptions& options) : options(options) {}
+
+BookmarkStore::~BookmarkStore() {
+    close();
+}
+
+bool BookmarkStore::open(const std::string& snapshot) {
+    close();
+    entries = RadixMap<std::string>();
+    snapshotPath = snapshot;
+    journalPath = std::filesystem::path(snapshot).replace_extension(".journal").string();
+
+    loadSnapshot();
+    replayJournal();
+
+    journalFd = ::open(journalPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journalFd < 0) {
+        std::cerr << "Failed to open bookmark journal " << journalPath << std::endl;
+        return false;
+    }
+    maybeCompact();
+    return true;
+}
+
+void BookmarkStore::close() {
+    if (journalFd < 0) {
+        return;
+    }
+    if (journalRecords > 0) {
+        compact();
+    }
+    ::close(journalFd);
+    journalFd = -1;
+}
+
+bool BookmarkStore::loadSnapshot() {
+    std::ifstream file(snapshotPath);
+    if (!file) {
+        return false; // File might not exist on first run
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t bar = line.find('|');
+        if (bar != std::string::npos && bar > 0) {
+            entries.insert_or_assign(line.substr(0, bar), line.substr(bar + 1));
+        }
+    }
+    return true;
+}
+
+void BookmarkStore::replayJournal() {
+    std::ifstream file(journalPath, std::ios::binary);
+    journalRecords = 0;
+    if (!file) {
+        return;
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t pos = 0;
+    while (true) {
+        size_t eol = contents.find('\n', pos);
+        if (eol == std::string::npos) {
+            break; // torn final record from a crash mid-write
+        }
+        std::string record = contents.substr(pos, eol - pos);
+        pos = eol + 1;
+        if (record.size() < 2) {
+            continue;
+        }
+        if (record[0] == '+') {
+            size_t bar = record.find('|');
+            if (bar != std::string::npos && bar > 1) {
+                entries.insert_or_assign(record.substr(1, bar - 1), record.substr(bar + 1));
+            }
+        } else if (record[0] == '-') {
+            entries.erase(record.substr(1));
+        }
+        ++journalRecords;
+    }
+    if (pos < contents.size()) {
+        // Drop the torn tail so new records do not get glued onto it
+        truncate(journalPath.c_str(), static_cast<off_t>(pos));
+    }
+}
+
+bool BookmarkStore::append(const std::string& record) {
+    if (journalFd < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t n = ::write(journalFd, record.data() + written, record.size() - written);
+        if (n < 0) {
+            std::cerr << "Failed to write bookmark journal" << std::endl;
+            return false;
+        }
+        written += n;
+    }
+    if (options.sync_each_write) {
+        fdatasync(journalFd);
+    }
+    ++journalRecords;
+    maybeCompact();
+    return true;
+}
+
+void BookmarkStore::maybeCompact() {
+    if (journalRecords >= options.compact_min_records && journalRecords >= entries.size()) {
+        compact();
+    }
+}
+
+bool BookmarkStore::add(const std::string& word, const std::string& note) {
+    if (word.empty() || word.find_first_of("|\n") != std::string::npos) {
+        return false;
+    }
+    std::string clean = note;
+    for (char& c : clean) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    entries.insert_or_assign(word, clean);
+    return append("+" + word + "|" + clean + "\n");
+}
+
+bool BookmarkStore::remove(const std::string& word) {
+    if (!entries.erase(word)) {
+        return false;
+    }
+    append("-" + word + "\n");
+    return true;
+}
+
+std::vector<std::pair<std::string, std::string>> BookmarkStore::list(const std::string& prefix, size_t offset,
+                                                                     size_t limit) const {
+    return entries.listPrefix(prefix, offset, limit);
+}
+
+std::vector<std::string> BookmarkStore::fuzzy(const std::string& word, int max_distance, size_t limit) const {
+    return entries.fuzzy(word, max_distance, limit);
+}
+
+bool BookmarkStore::compact() {
+    std::string tmpPath = snapshotPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to write " << tmpPath << std::endl;
+            return false;
+        }
+        std::string chunk;
+        for (auto& [word, note] : entries.listPrefix("")) {
+            chunk += word;
+            chunk += '|';
+            chunk += note;
+            chunk += '\n';
+            if (chunk.size() >= (1 << 16)) {
+                out << chunk;
+                chunk.clear();
+            }
+        }
+        out << chunk;
+        if (!out.flush()) {
+            std::cerr << "Failed to write " << tmpPath << std::endl;
+            return false;
+        }
+    }
+    // The new snapshot must be on disk before the journal it replaces is gone
+    int fd = ::open(tmpPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+    if (std::rename(tmpPath.c_str(), snapshotPath.c_str()) != 0) {
+        std::cerr << "Failed to replace " << snapshotPath << std::endl;
+        return false;
+    }
+    // ...and so must the rename: until the directory entry is synced a
+    // crash can bring back the old snapshot, which only the journal
+    // completes
+    std::string dir = std::filesystem::path(snapshotPath).parent_path().string();
+    int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    bool synced = dirFd >= 0 && fsync(dirFd) == 0;
+    if (dirFd >= 0) {
+        ::close(dirFd);
+    }
+    if (!synced) {
+        std::cerr << "Failed to sync the directory of " << snapshotPath << std::endl;
+        return false;
+    }
+    if (journalFd >= 0 && ftruncate(journalFd, 0) != 0) {
+        return false;
+    }
+    journalRecords = 0;
+    return true;
+}
@@ -1,7 +1,12 @@
 #include "../include/database.hpp"
+#include "../include/metrics.hpp"
 #include <sqlite3.h>
+#include <cctype>
+#include <chrono>
+#include <ctime>
 #include <iostream>
 #include <filesystem>
+#include <string_view>
 
 // SQL statements
 const char* CREATE_TABLES = R"(
@@ -12,50 +17,254 @@ const char* CREATE_TABLES = R"(
         created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
     );
     
-    CREATE TABLE IF NOT EXISTS search_history (
-        id INTEGER PRIMARY KEY AUTOINCREMENT,
+    -- One row per word with running totals; last_searched is unix time
+    CREATE TABLE IF NOT EXISTS search_counts (
+        word TEXT PRIMARY KEY,
+        search_count INTEGER NOT NULL DEFAULT 0,
+        last_searched INTEGER NOT NULL DEFAULT 0
+    ) WITHOUT ROWID;
+    
+    -- Covers get_search_history, so it never touches the table
+    CREATE INDEX IF NOT EXISTS idx_search_counts_recent
+        ON search_counts(last_searched DESC, word, search_count);
+    
+    -- Searches per word per UTC day (days since the epoch)
+    CREATE TABLE IF NOT EXISTS search_daily (
+        day INTEGER NOT NULL,
         word TEXT NOT NULL,
-        search_count INTEGER DEFAULT 1,
-        last_searched TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-        FOREIGN KEY (word) REFERENCES words(word) ON DELETE CASCADE
+        search_count INTEGER NOT NULL,
+        PRIMARY KEY (day, word)
+    ) WITHOUT ROWID;
+    
+    -- words.word is already indexed by its UNIQUE constraint
+    DROP INDEX IF EXISTS idx_word;
+)";
+
+// Full-text index over meanings. It is an external-content table that
+// stores only the index and reads text back from `words`; the triggers keep
+// it in step with every insert, update and delete. Bulk ingest sets
+// fts_sync.deferred inside its transaction and indexes all new rows with
+// one INSERT ... SELECT instead, which is several times faster than firing
+// the insert trigger per row.
+const char* CREATE_FTS = R"(
+    CREATE VIRTUAL TABLE IF NOT EXISTS words_fts USING fts5(
+        meaning, content='words', content_rowid='id', tokenize='porter unicode61'
     );
     
-    CREATE INDEX IF NOT EXISTS idx_word ON words(word);
-    CREATE INDEX IF NOT EXISTS idx_search_history ON search_history(word);
+    CREATE TABLE IF NOT EXISTS fts_sync (
+        id INTEGER PRIMARY KEY CHECK (id = 0),
+        deferred INTEGER NOT NULL
+    );
+    INSERT OR IGNORE INTO fts_sync (id, deferred) VALUES (0, 0);
+    
+    CREATE TRIGGER IF NOT EXISTS words_fts_insert AFTER INSERT ON words
+    WHEN (SELECT deferred FROM fts_sync) = 0 BEGIN
+        INSERT INTO words_fts(rowid, meaning) VALUES (new.id, new.meaning);
+    END;
+    
+    CREATE TRIGGER IF NOT EXISTS words_fts_delete AFTER DELETE ON words BEGIN
+        INSERT INTO words_fts(words_fts, rowid, meaning) VALUES ('delete', old.id, old.meaning);
+    END;
+    
+    CREATE TRIGGER IF NOT EXISTS words_fts_update AFTER UPDATE OF meaning ON words BEGIN
+        INSERT INTO words_fts(words_fts, rowid, meaning) VALUES ('delete', old.id, old.meaning);
+        INSERT INTO words_fts(rowid, meaning) VALUES (new.id, new.meaning);
+    END;
 )";
 
-// Constructor
-DictionaryDB::DictionaryDB(const std::string& db_path) : db(nullptr) {
-    // Create user data directory if it doesn't exist
-    std::string dir_path = std::string(getenv("HOME")) + "/.local/share/dictionary";
-    std::filesystem::create_directories(dir_path);
+// Folds the old row-per-event search_history table into search_counts
+const char* MIGRATE_SEARCH_HISTORY = R"(
+    BEGIN;
+    INSERT OR IGNORE INTO search_counts (word, search_count, last_searched)
+        SELECT word, SUM(search_count),
+               COALESCE(MAX(CAST(strftime('%s', last_searched) AS INTEGER)), 0)
+        FROM search_history GROUP BY word;
+    DROP TABLE search_history;
+    COMMIT;
+)";
+
+// Indexed by DictionaryDB::Statement
+const char* STATEMENT_SQL[] = {
+    // AddWord (an upsert rather than REPLACE, so the FTS update trigger fires)
+    R"(
+        INSERT INTO words (word, meaning) VALUES (?, ?)
+        ON CONFLICT(word) DO UPDATE SET meaning = excluded.meaning;
+    )",
+    // GetMeaning
+    "SELECT meaning FROM words WHERE word = ?;",
+    // WordExists
+    "SELECT 1 FROM words WHERE word = ?;",
+    // RecordSearch
+    R"(
+        INSERT INTO search_counts (word, search_count, last_searched)
+        VALUES (?1, ?2, ?3)
+        ON CONFLICT(word) DO UPDATE SET
+            search_count = search_count + excluded.search_count,
+            last_searched = excluded.last_searched;
+    )",
+    // RecordSearchDaily
+    R"(
+        INSERT INTO search_daily (day, word, search_count)
+        VALUES (?1, ?2, ?3)
+        ON CONFLICT(day, word) DO UPDATE SET
+            search_count = search_count + excluded.search_count;
+    )",
+    // SearchHistory
+    "SELECT word, search_count FROM search_counts ORDER BY last_searched DESC LIMIT ?;",
+    // DailyCounts
+    "SELECT day, search_count FROM search_daily WHERE word = ?1 AND day > ?2 ORDER BY day;",
+    // PruneDaily
+    "DELETE FROM search_daily WHERE day < ?;",
+    // SearchDefinitions
+    R"(
+        SELECT w.word, snippet(words_fts, 0, '[', ']', '...', 12), bm25(words_fts)
+        FROM words_fts JOIN words w ON w.id = words_fts.rowid
+        WHERE words_fts MATCH ?1
+        ORDER BY rank
+        LIMIT ?2;
+    )",
+};
+
+namespace {
+
+// Hands out a cached statement and resets it when the call is done, so the
+// statement never holds a read transaction open between calls.
+class StatementLease {
+private:
+    sqlite3_stmt* stmt;
+    
+public:
+    explicit StatementLease(sqlite3_stmt* s) : stmt(s) {}
+    ~StatementLease() {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+    
+    StatementLease(const StatementLease&) = delete;
+    StatementLease& operator=(const StatementLease&) = delete;
     
-    std::string full_path = dir_path + "/" + db_path;
+    sqlite3_stmt* get() const { return stmt; }
+    explicit operator bool() const { return stmt != nullptr; }
+    
+    void bind(int index, const std::string& text) {
+        sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+    }
+    
+    // Copies a text column straight into a string of the right length
+    std::string column_text(int index) const {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, index));
+        if (!text) {
+            return std::string();
+        }
+        return std::string(text, sqlite3_column_bytes(stmt, index));
+    }
+};
+
+} // namespace
+
+
+// Constructor
+DictionaryDB::DictionaryDB(const std::string& db_path, const DictionaryDBOptions& options)
+    : options(options), cache(options.cache) {
+    std::string full_path = db_path;
+    if (db_path != ":memory:" && !std::filesystem::path(db_path).is_absolute()) {
+        // Create user data directory if it doesn't exist
+        std::string dir_path = std::string(getenv("HOME")) + "/.local/share/dictionary";
+        std::filesystem::create_directories(dir_path);
+        full_path = dir_path + "/" + db_path;
+    }
     
-    if (sqlite3_open(full_path.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+    if (!open_connection(primary, full_path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)) {
         return;
     }
     
     // Enable foreign keys
-    sqlite3_exec(db, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
+    sqlite3_exec(primary.handle, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
     
     // Create tables
     if (!create_tables()) {
         std::cerr << "Failed to create database tables" << std::endl;
     }
+    
+    prepare_statements(primary);
+    open_read_pool(full_path);
+    writer = std::thread(&DictionaryDB::writer_loop, this);
 }
 
 // Destructor
 DictionaryDB::~DictionaryDB() {
-    if (db) {
-        sqlite3_close(db);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    writer_cv.notify_one();
+    if (writer.joinable()) {
+        writer.join();  // drains the queue before exiting
+    }
+    
+    for (Connection& reader : readers) {
+        close_connection(reader);
+    }
+    close_connection(primary);
+}
+
+bool DictionaryDB::open_connection(Connection& conn, const std::string& path, int flags) {
+    // Every connection is confined to one thread at a time (db_mutex or a
+    // ReadLease), so SQLite's own per-connection mutex is redundant.
+    if (sqlite3_open_v2(path.c_str(), &conn.handle, flags | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(conn.handle) << std::endl;
+        sqlite3_close(conn.handle);
+        conn.handle = nullptr;
+        return false;
+    }
+    sqlite3_busy_timeout(conn.handle, options.busy_timeout_ms);
+    apply_options(conn.handle);
+    return true;
+}
+
+void DictionaryDB::close_connection(Connection& conn) {
+    for (sqlite3_stmt*& stmt : conn.statements) {
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+    }
+    if (conn.handle) {
+        sqlite3_close(conn.handle);
+        conn.handle = nullptr;
+    }
+}
+
+void DictionaryDB::open_read_pool(const std::string& path) {
+    if (options.read_connections == 0) {
+        return;
+    }
+    // Separate connections to :memory: would each see an empty database,
+    // and without WAL readers and the writer block each other.
+    if (path == ":memory:" || !options.wal) {
+        std::cerr << "Read pool needs a WAL file database; reads stay on one connection" << std::endl;
+        return;
+    }
+    
+    readers.resize(options.read_connections);
+    for (Connection& reader : readers) {
+        if (!open_connection(reader, path, SQLITE_OPEN_READONLY)) {
+            break;
+        }
+        prepare_statements(reader);
+        idle_readers.push_back(&reader);
+    }
+    if (idle_readers.empty()) {
+        for (Connection& reader : readers) {
+            close_connection(reader);
+        }
+        readers.clear();
     }
 }
 
 bool DictionaryDB::create_tables() {
     char* err_msg = nullptr;
-    int rc = sqlite3_exec(db, CREATE_TABLES, nullptr, nullptr, &err_msg);
+    int rc = sqlite3_exec(primary.handle, CREATE_TABLES, nullptr, nullptr, &err_msg);
     
     if (rc != SQLITE_OK) {
         std::cerr << "SQL error: " << err_msg << std::endl;
@@ -63,107 +272,543 @@ bool DictionaryDB::create_tables() {
         return false;
     }
     
+    // Databases created before search_counts still have the old table
+    if (table_exists("search_history") &&
+        sqlite3_exec(primary.handle, MIGRATE_SEARCH_HISTORY, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::cerr << "Failed to migrate search history: " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+        sqlite3_exec(primary.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+    
+    // Index meanings that were stored before the FTS table existed
+    bool had_fts = table_exists("words_fts");
+    if (sqlite3_exec(primary.handle, CREATE_FTS, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::cerr << "Failed to create definition index: " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+    } else if (!had_fts) {
+        sqlite3_exec(primary.handle, "INSERT INTO words_fts(words_fts) VALUES ('rebuild');", nullptr, nullptr, nullptr);
+    }
+    
     return true;
 }
 
-bool DictionaryDB::add_word(const std::string& word, const std::string& meaning) {
-    std::string sql = "INSERT OR REPLACE INTO words (word, meaning) VALUES (?, ?);";
-    sqlite3_stmt* stmt;
+bool DictionaryDB::table_exists(const std::string& name) {
+    sqlite3_stmt* stmt = nullptr;
+    bool exists = false;
+    if (sqlite3_prepare_v2(primary.handle, "SELECT 1 FROM sqlite_master WHERE name = ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+void DictionaryDB::apply_options(sqlite3* handle) {
+    std::string pragmas;
+    if (options.wal) {
+        pragmas += "PRAGMA journal_mode = WAL;";
+    }
+    pragmas += "PRAGMA synchronous = " + options.synchronous + ";";
+    pragmas += "PRAGMA mmap_size = " + std::to_string(options.mmap_size) + ";";
+    // Negative cache_size is in KiB rather than pages
+    pragmas += "PRAGMA cache_size = -" + std::to_string(options.cache_size_kib) + ";";
+    pragmas += "PRAGMA temp_store = MEMORY;";
     
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    char* err_msg = nullptr;
+    if (sqlite3_exec(handle, pragmas.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::cerr << "Failed to apply database options: " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+    }
+}
+
+void DictionaryDB::prepare_statements(Connection& conn) {
+    for (size_t i = 0; i < conn.statements.size(); ++i) {
+        // A statement that fails to prepare stays null; its method then
+        // behaves as if the row was not found. Read-only connections prepare
+        // the write statements too but never step them.
+        if (sqlite3_prepare_v3(conn.handle, STATEMENT_SQL[i], -1, SQLITE_PREPARE_PERSISTENT,
+                               &conn.statements[i], nullptr) != SQLITE_OK) {
+            conn.statements[i] = nullptr;
+        }
+    }
+}
+
+DictionaryDB::ReadLease::ReadLease(DictionaryDB& owner) : owner(owner), conn(nullptr) {
+    // readers never changes after construction, so it can be read unlocked
+    if (owner.readers.empty()) {
+        write_lock = std::unique_lock<std::mutex>(owner.db_mutex);
+        conn = &owner.primary;
+        return;
+    }
+    std::unique_lock<std::mutex> lock(owner.pool_mutex);
+    owner.pool_cv.wait(lock, [&owner] { return !owner.idle_readers.empty(); });
+    conn = owner.idle_readers.back();
+    owner.idle_readers.pop_back();
+}
+
+DictionaryDB::ReadLease::~ReadLease() {
+    if (write_lock.owns_lock()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(owner.pool_mutex);
+        owner.idle_readers.push_back(conn);
+    }
+    owner.pool_cv.notify_one();
+}
+
+bool DictionaryDB::wait_for_space(std::unique_lock<std::mutex>& lock, bool droppable) {
+    if (pending_count() < options.write_queue_capacity) {
+        return true;
+    }
+    if (droppable && options.backpressure == WriteBackpressure::DropSearches) {
+        ++dropped_searches;
         return false;
     }
+    writer_cv.notify_one();
+    space_cv.wait(lock, [this] { return pending_count() < options.write_queue_capacity; });
+    return true;
+}
+
+bool DictionaryDB::add_word(const std::string& word, const std::string& meaning) {
+    METRIC_TIMER(DbAddWord);
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        auto it = pending_words.find(word);
+        if (it != pending_words.end()) {
+            it->second = meaning;
+        } else {
+            wait_for_space(lock, false);
+            pending_words.emplace(word, meaning);
+            if (pending_count() >= options.flush_batch) {
+                writer_cv.notify_one();
+            }
+        }
+    }
+    // Only once queued: a reader whose fill token predates this put sees the
+    // put bump the generation, one whose token follows it finds the queue
+    cache.put(word, std::make_shared<const std::string>(meaning));
+    return true;
+}
+
+size_t DictionaryDB::add_words(const std::vector<std::pair<std::string, std::string>>& batch) {
+    METRIC_TIMER(DbAddWords);
+    if (batch.empty()) {
+        return 0;
+    }
     
-    sqlite3_bind_text(stmt, 1, word.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, meaning.c_str(), -1, SQLITE_STATIC);
+    // One journal commit for the whole batch instead of one per row
+    std::lock_guard<std::mutex> guard(db_mutex);
+    StatementLease stmt(primary.statement(Statement::AddWord));
+    if (!stmt) {
+        return 0;
+    }
+    if (sqlite3_exec(primary.handle, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        return 0;
+    }
     
-    bool result = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    // New rows get ids above the current maximum (AUTOINCREMENT); they are
+    // indexed in one pass below. Replaced meanings still go through the
+    // update trigger.
+    sqlite3_int64 first_new_id = 0;
+    sqlite3_stmt* max_id = nullptr;
+    if (sqlite3_prepare_v2(primary.handle, "SELECT COALESCE(MAX(id), 0) FROM words;", -1, &max_id, nullptr) == SQLITE_OK &&
+        sqlite3_step(max_id) == SQLITE_ROW) {
+        first_new_id = sqlite3_column_int64(max_id, 0) + 1;
+    }
+    sqlite3_finalize(max_id);
+    sqlite3_exec(primary.handle, "UPDATE fts_sync SET deferred = 1;", nullptr, nullptr, nullptr);
+    
+    // A word repeated within the batch is written once, with its last
+    // meaning: a second write would go through the update trigger and ask
+    // FTS to delete an entry the deferred first insert never made
+    std::vector<const std::pair<std::string, std::string>*> rows;
+    rows.reserve(batch.size());
+    {
+        std::unordered_map<std::string_view, size_t> position;
+        position.reserve(batch.size());
+        for (const auto& entry : batch) {
+            auto [it, inserted] = position.emplace(entry.first, rows.size());
+            if (inserted) {
+                rows.push_back(&entry);
+            } else {
+                rows[it->second] = &entry;
+            }
+        }
+    }
+    
+    for (const auto* row : rows) {
+        const auto& [word, meaning] = *row;
+        stmt.bind(1, word);
+        stmt.bind(2, meaning);
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            std::cerr << "Bulk insert failed: " << sqlite3_errmsg(primary.handle) << std::endl;
+            sqlite3_reset(stmt.get());
+            sqlite3_exec(primary.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return 0;
+        }
+        sqlite3_reset(stmt.get());
+    }
     
-    return result;
+    std::string index_new = "INSERT INTO words_fts (rowid, meaning) "
+                            "SELECT id, meaning FROM words WHERE id >= " + std::to_string(first_new_id) + ";"
+                            "UPDATE fts_sync SET deferred = 0;";
+    if (sqlite3_exec(primary.handle, index_new.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK ||
+        sqlite3_exec(primary.handle, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_exec(primary.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return 0;
+    }
+    
+    // Meanings queued by add_word before this batch are older than it and
+    // must not be committed over it. Holding db_mutex keeps the writer out
+    // of write_batch, so its in-flight batch can be trimmed as well.
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        for (const auto* row : rows) {
+            pending_words.erase(row->first);
+            inflight_words.erase(row->first);
+        }
+    }
+    for (const auto* row : rows) {
+        cache.erase(row->first);
+    }
+    return batch.size();
 }
 
 std::string DictionaryDB::get_meaning(const std::string& word) {
-    std::string sql = "SELECT meaning FROM words WHERE word = ?;";
-    sqlite3_stmt* stmt;
-    std::string result;
-    
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    METRIC_TIMER(DbGetMeaning);
+    auto cached = cache.get(word);
+    if (cached.status == DefinitionCache::Status::Hit) {
+        METRIC_COUNT(CacheHit);
+        return *cached.meaning;
+    }
+    if (cached.status == DefinitionCache::Status::Negative) {
+        METRIC_COUNT(CacheNegativeHit);
         return "";
     }
+    METRIC_COUNT(CacheMiss);
+    uint64_t token = cache.fill_token(word);
     
-    sqlite3_bind_text(stmt, 1, word.c_str(), -1, SQLITE_STATIC);
-    
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        const unsigned char* meaning = sqlite3_column_text(stmt, 0);
-        if (meaning) {
-            result = reinterpret_cast<const char*>(meaning);
+    {
+        // Queued definitions win over what is on disk
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto it = pending_words.find(word);
+        if (it != pending_words.end()) {
+            return it->second;
+        }
+        it = inflight_words.find(word);
+        if (it != inflight_words.end()) {
+            return it->second;
         }
     }
     
-    sqlite3_finalize(stmt);
-    return result;
+    ReadLease conn(*this);
+    StatementLease stmt(conn.statement(Statement::GetMeaning));
+    if (!stmt) {
+        return "";
+    }
+    
+    stmt.bind(1, word);
+    
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        auto meaning = std::make_shared<const std::string>(stmt.column_text(0));
+        cache.fill(word, meaning, token);
+        return *meaning;
+    }
+    return "";
+}
+
+void DictionaryDB::mark_missing(const std::string& word) {
+    METRIC_TIMER(DbMarkMissing);
+    cache.put_negative(word);
+}
+
+bool DictionaryDB::known_missing(const std::string& word) {
+    METRIC_TIMER(DbKnownMissing);
+    return cache.get(word).status == DefinitionCache::Status::Negative;
 }
 
 bool DictionaryDB::word_exists(const std::string& word) {
-    std::string sql = "SELECT 1 FROM words WHERE word = ?;";
-    sqlite3_stmt* stmt;
-    bool exists = false;
+    METRIC_TIMER(DbWordExists);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (pending_words.count(word) || inflight_words.count(word)) {
+            return true;
+        }
+    }
     
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    ReadLease conn(*this);
+    StatementLease stmt(conn.statement(Statement::WordExists));
+    if (!stmt) {
         return false;
     }
     
-    sqlite3_bind_text(stmt, 1, word.c_str(), -1, SQLITE_STATIC);
-    exists = (sqlite3_step(stmt) == SQLITE_ROW);
-    
-    sqlite3_finalize(stmt);
-    return exists;
+    stmt.bind(1, word);
+    return sqlite3_step(stmt.get()) == SQLITE_ROW;
 }
 
 void DictionaryDB::record_search(const std::string& word) {
-    // Insert or update search count
-    std::string sql = R"(
-        INSERT INTO search_history (word, search_count, last_searched)
-        VALUES (?, 1, CURRENT_TIMESTAMP)
-        ON CONFLICT(word) DO UPDATE SET 
-            search_count = search_count + 1,
-            last_searched = CURRENT_TIMESTAMP;
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    METRIC_TIMER(DbRecordSearch);
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    auto it = pending_searches.find(word);
+    if (it != pending_searches.end()) {
+        ++it->second;
         return;
     }
-    
-    sqlite3_bind_text(stmt, 1, word.c_str(), -1, SQLITE_STATIC);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    if (!wait_for_space(lock, true)) {
+        return;
+    }
+    pending_searches.emplace(word, 1);
+    if (pending_count() >= options.flush_batch) {
+        writer_cv.notify_one();
+    }
 }
 
 std::vector<std::pair<std::string, int>> DictionaryDB::get_search_history(int limit) {
+    METRIC_TIMER(DbSearchHistory);
     std::vector<std::pair<std::string, int>> history;
-    std::string sql = "SELECT word, search_count FROM search_history ORDER BY last_searched DESC LIMIT ?;";
+    flush();
     
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    ReadLease conn(*this);
+    StatementLease stmt(conn.statement(Statement::SearchHistory));
+    if (!stmt) {
         return history;
     }
     
-    sqlite3_bind_int(stmt, 1, limit);
+    sqlite3_bind_int(stmt.get(), 1, limit);
     
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        const unsigned char* word = sqlite3_column_text(stmt, 0);
-        int count = sqlite3_column_int(stmt, 1);
-        
-        if (word) {
-            history.emplace_back(
-                reinterpret_cast<const char*>(word),
-                count
-            );
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        if (sqlite3_column_type(stmt.get(), 0) != SQLITE_NULL) {
+            history.emplace_back(stmt.column_text(0), sqlite3_column_int(stmt.get(), 1));
         }
     }
     
-    sqlite3_finalize(stmt);
     return history;
 }
+
+void DictionaryDB::flush() {
+    METRIC_TIMER(DbFlush);
+    if (!writer.joinable()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    flush_requested = true;
+    writer_cv.notify_one();
+    flushed_cv.wait(lock, [this] { return pending_count() == 0 && !writing; });
+}
+
+std::vector<std::pair<std::string, int>> DictionaryDB::get_daily_counts(const std::string& word, int days) {
+    METRIC_TIMER(DbDailyCounts);
+    std::vector<std::pair<std::string, int>> counts;
+    flush();
+    
+    ReadLease conn(*this);
+    StatementLease stmt(conn.statement(Statement::DailyCounts));
+    if (!stmt) {
+        return counts;
+    }
+    
+    stmt.bind(1, word);
+    sqlite3_bind_int64(stmt.get(), 2, std::time(nullptr) / 86400 - days);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        time_t day_start = static_cast<time_t>(sqlite3_column_int64(stmt.get(), 0)) * 86400;
+        char buf[16];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d", std::gmtime(&day_start));
+        counts.emplace_back(buf, sqlite3_column_int(stmt.get(), 1));
+    }
+    
+    return counts;
+}
+
+std::vector<DefinitionMatch> DictionaryDB::search_definitions(const std::string& query, int limit) {
+    METRIC_TIMER(DbSearchDefinitions);
+    std::vector<DefinitionMatch> matches;
+    
+    // Quote every term so user text can never be read as FTS5 syntax;
+    // adjacent strings are ANDed together.
+    std::string fts_query;
+    std::string term;
+    for (size_t i = 0; i <= query.size(); ++i) {
+        unsigned char c = i < query.size() ? query[i] : ' ';
+        if (std::isalnum(c) || c >= 0x80 || c == '\'') {
+            term.push_back(static_cast<char>(c));
+        } else if (!term.empty()) {
+            fts_query += (fts_query.empty() ? "\"" : " \"") + term + "\"";
+            term.clear();
+        }
+    }
+    if (fts_query.empty()) {
+        return matches;
+    }
+    
+    flush();  // queued definitions become searchable
+    
+    ReadLease conn(*this);
+    StatementLease stmt(conn.statement(Statement::SearchDefinitions));
+    if (!stmt) {
+        return matches;
+    }
+    
+    stmt.bind(1, fts_query);
+    sqlite3_bind_int(stmt.get(), 2, limit);
+    
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        matches.push_back({stmt.column_text(0), stmt.column_text(1), sqlite3_column_double(stmt.get(), 2)});
+    }
+    
+    return matches;
+}
+
+size_t DictionaryDB::dropped_search_events() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return dropped_searches;
+}
+
+size_t DictionaryDB::lost_write_events() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return lost_writes;
+}
+
+void DictionaryDB::writer_loop() {
+    auto interval = std::chrono::milliseconds(options.flush_interval_ms);
+    int failures = 0;  // consecutive failed batches
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (true) {
+        writer_cv.wait_for(lock, interval, [this] {
+            return stopping || flush_requested || pending_count() >= options.flush_batch;
+        });
+        if (pending_count() == 0) {
+            flush_requested = false;
+            flushed_cv.notify_all();
+            if (stopping) {
+                return;
+            }
+            continue;
+        }
+        
+        std::unordered_map<std::string, int> searches;
+        searches.swap(pending_searches);
+        inflight_words.swap(pending_words);
+        writing = true;
+        space_cv.notify_all();
+        
+        // Readers only look at inflight_words while we commit it
+        lock.unlock();
+        bool written = write_batch(inflight_words, searches);
+        lock.lock();
+        
+        if (written) {
+            failures = 0;
+        } else if (++failures <= options.write_retries) {
+            // Callers were told these writes succeeded: queue them again.
+            // A meaning queued since is newer and wins; counts add up.
+            for (auto& [word, meaning] : inflight_words) {
+                pending_words.try_emplace(word, std::move(meaning));
+            }
+            for (const auto& [word, count] : searches) {
+                pending_searches[word] += count;
+            }
+        } else {
+            lost_writes += inflight_words.size() + searches.size();
+            std::cerr << "Write-behind flush failed " << failures << " times in a row; dropped "
+                      << inflight_words.size() << " definitions and " << searches.size()
+                      << " search counts" << std::endl;
+            failures = 0;
+        }
+        inflight_words.clear();
+        writing = false;
+        flushed_cv.notify_all();
+        if (failures > 0) {
+            // Give whatever holds the database an interval before retrying;
+            // producers filling the queue must not cut it short
+            auto retry_at = std::chrono::steady_clock::now() + interval;
+            writer_cv.wait_until(lock, retry_at, [] { return false; });
+        }
+    }
+}
+
+bool DictionaryDB::write_batch(const std::unordered_map<std::string, std::string>& words,
+                               const std::unordered_map<std::string, int>& searches) {
+    METRIC_TIMER(DbWriteBatch);
+    std::lock_guard<std::mutex> guard(db_mutex);
+    if (sqlite3_exec(primary.handle, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Write-behind flush failed: " << sqlite3_errmsg(primary.handle) << std::endl;
+        return false;
+    }
+    auto fail = [this](sqlite3_stmt* stmt) {
+        std::cerr << "Write-behind flush failed: " << sqlite3_errmsg(primary.handle) << std::endl;
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+        sqlite3_exec(primary.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    };
+    
+    sqlite3_stmt* add = primary.statement(Statement::AddWord);
+    if (!add && !words.empty()) {
+        return fail(nullptr);
+    }
+    for (const auto& [word, meaning] : words) {
+        sqlite3_bind_text(add, 1, word.data(), static_cast<int>(word.size()), SQLITE_STATIC);
+        sqlite3_bind_text(add, 2, meaning.data(), static_cast<int>(meaning.size()), SQLITE_STATIC);
+        if (sqlite3_step(add) != SQLITE_DONE) {
+            return fail(add);
+        }
+        sqlite3_reset(add);
+    }
+    if (add) {
+        sqlite3_clear_bindings(add);
+    }
+    
+    // The whole batch is stamped with the flush time; events are at most
+    // one flush interval old by now.
+    sqlite3_int64 now = std::time(nullptr);
+    sqlite3_int64 today = now / 86400;
+    sqlite3_stmt* record = primary.statement(Statement::RecordSearch);
+    sqlite3_stmt* daily = primary.statement(Statement::RecordSearchDaily);
+    if ((!record || !daily) && !searches.empty()) {
+        return fail(nullptr);
+    }
+    for (const auto& [word, count] : searches) {
+        sqlite3_bind_text(record, 1, word.data(), static_cast<int>(word.size()), SQLITE_STATIC);
+        sqlite3_bind_int(record, 2, count);
+        sqlite3_bind_int64(record, 3, now);
+        if (sqlite3_step(record) != SQLITE_DONE) {
+            return fail(record);
+        }
+        sqlite3_reset(record);
+        
+        sqlite3_bind_int64(daily, 1, today);
+        sqlite3_bind_text(daily, 2, word.data(), static_cast<int>(word.size()), SQLITE_STATIC);
+        sqlite3_bind_int(daily, 3, count);
+        if (sqlite3_step(daily) != SQLITE_DONE) {
+            return fail(daily);
+        }
+        sqlite3_reset(daily);
+    }
+    if (record && daily) {
+        sqlite3_clear_bindings(record);
+        sqlite3_clear_bindings(daily);
+    }
+    
+    // Daily buckets past the retention window are dropped once a day; the
+    // all-time totals stay in search_counts. Pruning is housekeeping, so a
+    // failure here only means trying again with the next batch.
+    sqlite3_stmt* prune = primary.statement(Statement::PruneDaily);
+    if (prune && today != last_pruned_day) {
+        sqlite3_bind_int64(prune, 1, today - options.search_daily_retention_days);
+        if (sqlite3_step(prune) == SQLITE_DONE) {
+            last_pruned_day = today;
+        }
+        sqlite3_reset(prune);
+    }
+    
+    if (sqlite3_exec(primary.handle, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Write-behind commit failed: " << sqlite3_errmsg(primary.handle) << std::endl;
+        sqlite3_exec(primary.handle, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
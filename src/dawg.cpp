@@ -0,0 +1,344 @@
+#include "dawg.hpp"
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+// Mutable state used only while building; indices are build-time ids.
+struct BuildState {
+  bool final = false;
+  std::vector<std::pair<unsigned char, uint32_t>> edges;
+};
+
+// Two states are equivalent when finality and all outgoing edges match.
+// Targets are already minimized, so comparing their ids is enough.
+std::string signature(const BuildState &state) {
+  std::string sig(1, state.final ? '1' : '0');
+  for (auto &[label, target] : state.edges) {
+    sig.push_back(static_cast<char>(label));
+    sig.append(reinterpret_cast<const char *>(&target), sizeof(target));
+  }
+  return sig;
+}
+
+size_t commonPrefixLen(const std::string &a, const std::string &b) {
+  size_t len = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < len && a[i] == b[i])
+    ++i;
+  return i;
+}
+
+} // namespace
+
+Dawg::Dawg() : edgeBegin{0, 0}, stateInfo{0} {}
+
+Dawg Dawg::build(const RadixTree &tree) {
+  std::vector<std::string> words = tree.starts_with("");
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  // Incremental construction from sorted input (Daciuk et al.): states of
+  // the previous word beyond the common prefix can no longer change, so they
+  // are replaced by an equivalent registered state or registered themselves.
+  std::vector<BuildState> states(1);
+  std::unordered_map<std::string, uint32_t> registry;
+  std::vector<uint32_t> path{0};
+  auto minimize = [&](size_t depth) {
+    while (path.size() - 1 > depth) {
+      uint32_t child = path.back();
+      path.pop_back();
+      auto [it, inserted] = registry.emplace(signature(states[child]), child);
+      if (!inserted) {
+        states[path.back()].edges.back().second = it->second;
+        std::vector<std::pair<unsigned char, uint32_t>>().swap(
+            states[child].edges);
+      }
+    }
+  };
+
+  std::string prev;
+  for (auto &w : words) {
+    minimize(commonPrefixLen(w, prev));
+    for (size_t i = path.size() - 1; i < w.size(); ++i) {
+      states.emplace_back();
+      uint32_t id = states.size() - 1;
+      states[path.back()].edges.emplace_back(static_cast<unsigned char>(w[i]),
+                                             id);
+      path.push_back(id);
+    }
+    states[path.back()].final = true;
+    prev = w;
+  }
+  minimize(0);
+  registry.clear();
+
+  // Renumber reachable states depth-first and count words below each one.
+  std::vector<uint32_t> newId(states.size(), UINT32_MAX);
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> stack{0};
+  while (!stack.empty()) {
+    uint32_t s = stack.back();
+    stack.pop_back();
+    if (newId[s] != UINT32_MAX)
+      continue;
+    newId[s] = order.size();
+    order.push_back(s);
+    for (auto it = states[s].edges.rbegin(); it != states[s].edges.rend();
+         ++it)
+      if (newId[it->second] == UINT32_MAX)
+        stack.push_back(it->second);
+  }
+
+  std::vector<uint32_t> below(states.size(), UINT32_MAX);
+  auto countBelow = [&](auto &self, uint32_t s) -> uint32_t {
+    if (below[s] != UINT32_MAX)
+      return below[s];
+    uint32_t n = states[s].final ? 1 : 0;
+    for (auto &edge : states[s].edges)
+      n += self(self, edge.second);
+    return below[s] = n;
+  };
+
+  Dawg dawg;
+  dawg.edgeBegin.assign(1, 0);
+  dawg.stateInfo.clear();
+  dawg.edgeBegin.reserve(order.size() + 1);
+  dawg.stateInfo.reserve(order.size());
+  for (uint32_t s : order) {
+    uint32_t info = countBelow(countBelow, s);
+    if (states[s].final)
+      info |= FINAL_BIT;
+    dawg.stateInfo.push_back(info);
+    for (auto &[label, target] : states[s].edges) {
+      dawg.edgeLabel.push_back(static_cast<char>(label));
+      dawg.edgeTarget.push_back(newId[target]);
+    }
+    dawg.edgeBegin.push_back(dawg.edgeTarget.size());
+  }
+
+  dawg.freqs.reserve(words.size());
+  for (auto &w : words)
+    dawg.freqs.push_back(std::max(0, tree.getWordInfo(w).frequency));
+  dawg.buildRangeMax();
+  return dawg;
+}
+
+int64_t Dawg::findEdge(uint32_t state, char c) const {
+  auto first = edgeLabel.begin() + edgeBegin[state];
+  auto last = edgeLabel.begin() + edgeBegin[state + 1];
+  auto it = std::lower_bound(first, last, c, [](char a, char b) {
+    return static_cast<unsigned char>(a) < static_cast<unsigned char>(b);
+  });
+  if (it == last || *it != c)
+    return -1;
+  return it - edgeLabel.begin();
+}
+
+bool Dawg::walk(const std::string &prefix, uint32_t &state,
+                uint32_t &rank) const {
+  state = 0;
+  rank = 0;
+  for (char c : prefix) {
+    int64_t e = findEdge(state, c);
+    if (e < 0)
+      return false;
+    // Words ending here and words under smaller labels sort before us
+    if (isFinal(state))
+      ++rank;
+    for (uint32_t i = edgeBegin[state]; i < e; ++i)
+      rank += wordsBelow(edgeTarget[i]);
+    state = edgeTarget[e];
+  }
+  return true;
+}
+
+std::string Dawg::wordAt(uint32_t rank) const {
+  std::string word;
+  uint32_t state = 0;
+  while (true) {
+    if (isFinal(state)) {
+      if (rank == 0)
+        return word;
+      --rank;
+    }
+    for (uint32_t i = edgeBegin[state]; i < edgeBegin[state + 1]; ++i) {
+      uint32_t n = wordsBelow(edgeTarget[i]);
+      if (rank < n) {
+        word.push_back(edgeLabel[i]);
+        state = edgeTarget[i];
+        break;
+      }
+      rank -= n;
+    }
+  }
+}
+
+bool Dawg::search(const std::string &key) const {
+  uint32_t state, rank;
+  return walk(key, state, rank) && isFinal(state);
+}
+
+void Dawg::collect_words(uint32_t state, std::string &prefix,
+                         std::vector<std::string> &words) const {
+  if (isFinal(state))
+    words.push_back(prefix);
+  for (uint32_t i = edgeBegin[state]; i < edgeBegin[state + 1]; ++i) {
+    prefix.push_back(edgeLabel[i]);
+    collect_words(edgeTarget[i], prefix, words);
+    prefix.pop_back();
+  }
+}
+
+std::vector<std::string> Dawg::starts_with(const std::string &prefix) const {
+  std::vector<std::string> results;
+  uint32_t state, rank;
+  if (!walk(prefix, state, rank))
+    return results;
+  results.reserve(wordsBelow(state));
+  std::string buf = prefix;
+  collect_words(state, buf, results);
+  return results;
+}
+
+void Dawg::suggestHelper(uint32_t state, std::string &prefix,
+                         const std::string &word,
+                         const std::vector<int> &prevRow, int max_distance,
+                         std::vector<std::string> &res) const {
+  if (isFinal(state) && prevRow.back() <= max_distance)
+    res.push_back(prefix);
+  std::vector<int> row(prevRow.size());
+  for (uint32_t i = edgeBegin[state]; i < edgeBegin[state + 1]; ++i) {
+    char c = edgeLabel[i];
+    row[0] = prevRow[0] + 1;
+    int best = row[0];
+    for (size_t j = 1; j < row.size(); ++j) {
+      row[j] = std::min({row[j - 1] + 1, prevRow[j] + 1,
+                         prevRow[j - 1] + (word[j - 1] == c ? 0 : 1)});
+      best = std::min(best, row[j]);
+    }
+    // Every extension of this path is at least `best` edits away
+    if (best > max_distance)
+      continue;
+    prefix.push_back(c);
+    suggestHelper(edgeTarget[i], prefix, word, row, max_distance, res);
+    prefix.pop_back();
+  }
+}
+
+std::vector<std::string> Dawg::suggest(const std::string &word,
+                                       int max_distance) const {
+  std::vector<std::string> res;
+  std::vector<int> row(word.size() + 1);
+  for (size_t j = 0; j < row.size(); ++j)
+    row[j] = j;
+  std::string prefix;
+  suggestHelper(0, prefix, word, row, max_distance, res);
+  return res;
+}
+
+void Dawg::buildRangeMax() {
+  blockMax.clear();
+  size_t blocks = (freqs.size() + BLOCK - 1) / BLOCK;
+  if (blocks == 0)
+    return;
+  std::vector<uint32_t> level(blocks);
+  for (size_t b = 0; b < blocks; ++b) {
+    size_t lo = b * BLOCK, hi = std::min(freqs.size(), lo + BLOCK);
+    size_t best = lo;
+    for (size_t i = lo + 1; i < hi; ++i)
+      if (freqs[i] > freqs[best])
+        best = i;
+    level[b] = best;
+  }
+  blockMax.push_back(std::move(level));
+  for (size_t width = 2; width <= blocks; width *= 2) {
+    const auto &prevLevel = blockMax.back();
+    std::vector<uint32_t> next(blocks - width + 1);
+    for (size_t b = 0; b < next.size(); ++b) {
+      uint32_t a = prevLevel[b], c = prevLevel[b + width / 2];
+      next[b] = freqs[c] > freqs[a] ? c : a;
+    }
+    blockMax.push_back(std::move(next));
+  }
+}
+
+uint32_t Dawg::argmaxRange(uint32_t lo, uint32_t hi) const {
+  uint32_t best = lo;
+  auto consider = [&](uint32_t i) {
+    if (freqs[i] > freqs[best] || (freqs[i] == freqs[best] && i < best))
+      best = i;
+  };
+  size_t firstBlock = lo / BLOCK, lastBlock = (hi - 1) / BLOCK;
+  if (firstBlock == lastBlock) {
+    for (uint32_t i = lo; i < hi; ++i)
+      consider(i);
+    return best;
+  }
+  for (uint32_t i = lo; i < (firstBlock + 1) * BLOCK; ++i)
+    consider(i);
+  for (uint32_t i = lastBlock * BLOCK; i < hi; ++i)
+    consider(i);
+  if (firstBlock + 1 < lastBlock) {
+    size_t from = firstBlock + 1, count = lastBlock - from;
+    size_t k = 0;
+    while ((size_t(2) << k) <= count)
+      ++k;
+    consider(blockMax[k][from]);
+    consider(blockMax[k][lastBlock - (size_t(1) << k)]);
+  }
+  return best;
+}
+
+std::vector<std::pair<std::string, int>>
+Dawg::topInRange(uint32_t lo, uint32_t hi, int K) const {
+  std::vector<std::pair<std::string, int>> result;
+  if (lo >= hi || K <= 0)
+    return result;
+  // Best-first search over rank intervals: each popped interval yields its
+  // maximum and splits into the parts on either side of it.
+  struct Interval {
+    uint32_t best, lo, hi;
+  };
+  auto worse = [this](const Interval &a, const Interval &b) {
+    if (freqs[a.best] != freqs[b.best])
+      return freqs[a.best] < freqs[b.best];
+    return a.best > b.best;
+  };
+  std::priority_queue<Interval, std::vector<Interval>, decltype(worse)> heap(
+      worse);
+  heap.push({argmaxRange(lo, hi), lo, hi});
+  while (!heap.empty() && result.size() < (size_t)K) {
+    Interval top = heap.top();
+    heap.pop();
+    result.emplace_back(wordAt(top.best), freqs[top.best]);
+    if (top.lo < top.best)
+      heap.push({argmaxRange(top.lo, top.best), top.lo, top.best});
+    if (top.best + 1 < top.hi)
+      heap.push({argmaxRange(top.best + 1, top.hi), top.best + 1, top.hi});
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, int>> Dawg::getTopNWords(int N) const {
+  return topInRange(0, freqs.size(), N);
+}
+
+std::vector<std::pair<std::string, int>>
+Dawg::topKWithPrefix(const std::string &prefix, int K) const {
+  uint32_t state, rank;
+  if (!walk(prefix, state, rank))
+    return {};
+  return topInRange(rank, rank + wordsBelow(state), K);
+}
+
+size_t Dawg::memoryUsage() const {
+  size_t bytes = edgeBegin.capacity() * sizeof(uint32_t) +
+                 stateInfo.capacity() * sizeof(uint32_t) +
+                 edgeLabel.capacity() * sizeof(char) +
+                 edgeTarget.capacity() * sizeof(uint32_t) +
+                 freqs.capacity() * sizeof(uint32_t);
+  for (auto &level : blockMax)
+    bytes += sizeof(level) + level.capacity() * sizeof(uint32_t);
+  return bytes;
+}
@@ -0,0 +1,130 @@
+#include "../include/definition_cache.hpp"
+#include <functional>
+
+namespace {
+
+// Approximate per-entry bookkeeping: list node, hash node and bucket slot
+const size_t ENTRY_OVERHEAD = 128;
+
+} // namespace
+
+DefinitionCache::DefinitionCache(const DefinitionCacheOptions& options)
+    : negative_ttl(std::chrono::seconds(options.negative_ttl_seconds)) {
+    size_t count = options.shards > 0 ? options.shards : 1;
+    shard_budget = options.max_bytes / count;
+    for (size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+DefinitionCache::Shard& DefinitionCache::shard_for(const std::string& word) {
+    return *shards[std::hash<std::string>()(word) % shards.size()];
+}
+
+DefinitionCache::Lookup DefinitionCache::get(const std::string& word) {
+    Shard& shard = shard_for(word);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    
+    auto it = shard.index.find(word);
+    if (it == shard.index.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+    
+    auto entry = it->second;
+    if (!entry->meaning) {
+        if (Clock::now() >= entry->expires) {
+            remove_locked(shard, entry);
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        negative_hits.fetch_add(1, std::memory_order_relaxed);
+        return {Status::Negative, nullptr};
+    }
+    
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return {Status::Hit, entry->meaning};
+}
+
+void DefinitionCache::put(const std::string& word, std::shared_ptr<const std::string> meaning) {
+    write(word, std::move(meaning), Clock::time_point::max());
+}
+
+void DefinitionCache::put_negative(const std::string& word) {
+    write(word, nullptr, Clock::now() + negative_ttl);
+}
+
+void DefinitionCache::erase(const std::string& word) {
+    Shard& shard = shard_for(word);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ++shard.generation;
+    auto it = shard.index.find(word);
+    if (it != shard.index.end()) {
+        remove_locked(shard, it->second);
+    }
+}
+
+uint64_t DefinitionCache::fill_token(const std::string& word) {
+    Shard& shard = shard_for(word);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.generation;
+}
+
+void DefinitionCache::fill(const std::string& word, std::shared_ptr<const std::string> meaning,
+                           uint64_t token) {
+    Shard& shard = shard_for(word);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.generation == token) {
+        insert_locked(shard, word, std::move(meaning), Clock::time_point::max());
+    }
+}
+
+void DefinitionCache::write(const std::string& word, std::shared_ptr<const std::string> meaning,
+                            Clock::time_point expires) {
+    Shard& shard = shard_for(word);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ++shard.generation;
+    insert_locked(shard, word, std::move(meaning), expires);
+}
+
+void DefinitionCache::insert_locked(Shard& shard, const std::string& word,
+                                    std::shared_ptr<const std::string> meaning, Clock::time_point expires) {
+    size_t bytes = ENTRY_OVERHEAD + word.size() + (meaning ? meaning->size() : 0);
+    auto it = shard.index.find(word);
+    if (it != shard.index.end()) {
+        remove_locked(shard, it->second);
+    }
+    if (bytes > shard_budget) {
+        return;  // would evict the whole shard for one entry
+    }
+    
+    shard.lru.push_front(Entry{word, std::move(meaning), expires, bytes});
+    shard.index.emplace(shard.lru.front().word, shard.lru.begin());
+    shard.bytes += bytes;
+    
+    while (shard.bytes > shard_budget) {
+        remove_locked(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DefinitionCache::remove_locked(Shard& shard, std::list<Entry>::iterator it) {
+    shard.bytes -= it->bytes;
+    shard.index.erase(it->word);
+    shard.lru.erase(it);
+}
+
+DefinitionCacheStats DefinitionCache::stats() const {
+    DefinitionCacheStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.negative_hits = negative_hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.evictions = evictions.load(std::memory_order_relaxed);
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->index.size();
+        s.bytes += shard->bytes;
+    }
+    return s;
+}
@@ -0,0 +1,220 @@
+#include "../include/definition_fetcher.hpp"
+#include "../include/json.hpp"
+#include "../include/metrics.hpp"
+#include <cstdlib>
+#include <sstream>
+
+const char* DefinitionFetcher::DEFAULT_URL = "https://api.dictionaryapi.dev/api/v2/entries/en/";
+
+namespace {
+
+size_t append_body(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+// Greedy word wrap; continuation lines are indented by four spaces
+std::string wrap(const std::string& text, size_t width = 80) {
+    const std::string indent = "    ";
+    std::istringstream words(text);
+    std::string word;
+    std::string out;
+    size_t line_length = 0;
+    bool line_start = true;
+    while (words >> word) {
+        if (!line_start && line_length + 1 + word.size() > width) {
+            out += "\n" + indent;
+            line_length = indent.size();
+            line_start = true;
+        }
+        if (!line_start) {
+            out += ' ';
+            ++line_length;
+        }
+        out += word;
+        line_length += word.size();
+        line_start = false;
+    }
+    return out;
+}
+
+} // namespace
+
+DefinitionFetcher::DefinitionFetcher(const std::string& base_url, long timeout_ms)
+    : curl(curl_easy_init()), base_url(resolve_base_url(base_url)), timeout_ms(timeout_ms) {
+    if (curl) {
+        configure(curl, timeout_ms);
+    }
+}
+
+void DefinitionFetcher::configure(CURL* handle, long timeout_ms) {
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, append_body);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);  // timeouts without SIGALRM, safe off the main thread
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");  // whatever compression libcurl supports
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "radix-dict/1.0");
+}
+
+DefinitionFetcher::~DefinitionFetcher() {
+    if (curl) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+void DefinitionFetcher::set_base_url(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex);
+    base_url = url;
+}
+
+std::string DefinitionFetcher::get_base_url() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return base_url;
+}
+
+FetchResult DefinitionFetcher::fetch(const std::string& word) {
+    FetchResult result;
+    std::string key = trim(word);
+    if (key.empty()) {
+        result.status = FetchResult::Status::NotFound;
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    METRIC_TIMER(Fetch);  // not counting the wait for the handle
+    if (!curl) {
+        result.error = "failed to initialize cURL";
+        return result;
+    }
+
+    std::string url = url_for(curl, base_url, key);
+    if (url.empty()) {
+        result.error = "failed to escape word";
+        return result;
+    }
+
+    std::string body;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+    if (res != CURLE_OK) {
+        METRIC_COUNT(FetchError);
+        result.error = curl_easy_strerror(res);
+        return result;
+    }
+
+    long http_status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+    result = interpret(http_status, body);
+    switch (result.status) {
+    case FetchResult::Status::Ok:
+        METRIC_COUNT(FetchOk);
+        break;
+    case FetchResult::Status::NotFound:
+        METRIC_COUNT(FetchNotFound);
+        break;
+    case FetchResult::Status::Error:
+        METRIC_COUNT(FetchError);
+        break;
+    }
+    return result;
+}
+
+std::string DefinitionFetcher::resolve_base_url(const std::string& base_url) {
+    if (!base_url.empty()) {
+        return base_url;
+    }
+    const char* env_url = std::getenv("DICT_API_URL");
+    return (env_url && *env_url) ? env_url : DEFAULT_URL;
+}
+
+std::string DefinitionFetcher::url_for(CURL* handle, const std::string& base_url, const std::string& word) {
+    // Escaping keeps the word a single path segment whatever it contains
+    char* escaped = curl_easy_escape(handle, word.c_str(), static_cast<int>(word.size()));
+    if (!escaped) {
+        return "";
+    }
+    std::string url = base_url + escaped;
+    curl_free(escaped);
+    return url;
+}
+
+FetchResult DefinitionFetcher::interpret(long http_status, const std::string& body) {
+    FetchResult result;
+    result.http_status = http_status;
+    if (http_status == 404) {
+        result.status = FetchResult::Status::NotFound;
+        return result;
+    }
+    if (http_status != 200) {
+        result.error = "HTTP " + std::to_string(http_status);
+        return result;
+    }
+
+    if (!parse_response(body, result.senses, &result.error)) {
+        return result;
+    }
+    result.status = result.senses.empty() ? FetchResult::Status::NotFound : FetchResult::Status::Ok;
+    return result;
+}
+
+bool DefinitionFetcher::parse_response(const std::string& body, std::vector<Sense>& senses, std::string* error) {
+    json::Value doc;
+    if (!json::parse(body, doc, error)) {
+        return false;
+    }
+    if (!doc.is_array()) {
+        if (error) {
+            *error = "expected a JSON array";
+        }
+        return false;
+    }
+
+    // Like the Python script, only the first entry is used
+    if (doc.array.empty()) {
+        return true;
+    }
+    const json::Value* meanings = doc.array[0].get("meanings");
+    if (!meanings || !meanings->is_array()) {
+        return true;
+    }
+    for (const json::Value& meaning : meanings->array) {
+        std::string pos = meaning.get_string("partOfSpeech");
+        const json::Value* definitions = meaning.get("definitions");
+        if (!definitions || !definitions->is_array()) {
+            continue;
+        }
+        for (const json::Value& block : definitions->array) {
+            std::string definition = trim(block.get_string("definition"));
+            if (!definition.empty()) {
+                senses.push_back({pos, definition, trim(block.get_string("example"))});
+            }
+        }
+    }
+    return true;
+}
+
+std::string DefinitionFetcher::format(const std::string& word, const std::vector<Sense>& senses) {
+    std::string out = "\033[1;32mDefinitions for '" + word + "':\033[0m\n";
+    for (size_t i = 0; i < senses.size(); ++i) {
+        const Sense& sense = senses[i];
+        std::string pos = sense.part_of_speech.empty() ? "" : " (" + sense.part_of_speech + ")";
+        out += std::to_string(i + 1) + ". " + pos + " " + wrap(sense.definition) + "\n";
+        if (!sense.example.empty()) {
+            out += "    e.g., " + wrap(sense.example) + "\n";
+        }
+    }
+    return out;
+}
@@ -0,0 +1,185 @@
+#include "../include/definition_import.hpp"
+#include "../include/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+// Buffered byte reader over stdio with large reads
+class ChunkReader {
+private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t len = 0;
+    size_t consumed = 0;
+    
+public:
+    explicit ChunkReader(FILE* f) : file(f), buffer(1 << 20) {}
+    
+    int get() {
+        if (pos == len) {
+            consumed += len;
+            len = std::fread(buffer.data(), 1, buffer.size(), file);
+            pos = 0;
+            if (len == 0) {
+                return EOF;
+            }
+        }
+        return static_cast<unsigned char>(buffer[pos++]);
+    }
+    
+    bool read_line(std::string& line) {
+        line.clear();
+        int c;
+        while ((c = get()) != EOF) {
+            if (c == '\n') {
+                return true;
+            }
+            line.push_back(static_cast<char>(c));
+        }
+        return !line.empty();
+    }
+    
+    size_t bytes_read() const { return consumed + pos; }
+};
+
+// Reads one RFC 4180 record (quoted fields may span lines)
+bool read_csv_record(ChunkReader& in, std::vector<std::string>& fields) {
+    fields.clear();
+    int c = in.get();
+    if (c == EOF) {
+        return false;
+    }
+    fields.emplace_back();
+    bool quoted = false;
+    for (; c != EOF; c = in.get()) {
+        std::string& field = fields.back();
+        if (quoted) {
+            if (c == '"') {
+                int next = in.get();
+                if (next == '"') {
+                    field.push_back('"');
+                    continue;
+                }
+                quoted = false;
+                c = next;
+                if (c == EOF) {
+                    break;
+                }
+            } else {
+                field.push_back(static_cast<char>(c));
+                continue;
+            }
+        }
+        if (c == '"' && field.empty()) {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            fields.back().push_back(static_cast<char>(c));
+        }
+    }
+    return true;
+}
+
+bool is_jsonl(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".jsonl" || ext == ".ndjson";
+}
+
+} // namespace
+
+ImportResult import_definitions(DictionaryDB& db, const std::string& path,
+                                const ImportProgress& progress, size_t batch_size) {
+    ImportResult result;
+    auto start = std::chrono::steady_clock::now();
+    
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return result;
+    }
+    std::error_code ec;
+    size_t total_bytes = std::filesystem::file_size(path, ec);
+    
+    ChunkReader in(file);
+    std::vector<std::pair<std::string, std::string>> batch;
+    batch.reserve(batch_size);
+    result.ok = true;
+    
+    auto commit = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        size_t written = db.add_words(batch);
+        if (written == 0) {
+            result.ok = false;
+        }
+        result.rows += written;
+        batch.clear();
+        if (progress) {
+            progress(result.rows, in.bytes_read(), total_bytes);
+        }
+    };
+    
+    auto add = [&](std::string word, std::string meaning) {
+        if (word.empty() || meaning.empty()) {
+            ++result.skipped;
+            return;
+        }
+        batch.emplace_back(std::move(word), std::move(meaning));
+        if (batch.size() >= batch_size) {
+            commit();
+        }
+    };
+    
+    if (is_jsonl(path)) {
+        std::string line;
+        json::Value record;
+        while (result.ok && in.read_line(line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            if (!json::parse(line, record) || !record.is_object()) {
+                ++result.skipped;
+                continue;
+            }
+            std::string meaning = record.get_string("meaning");
+            if (meaning.empty()) {
+                meaning = record.get_string("definition");
+            }
+            add(record.get_string("word"), std::move(meaning));
+        }
+    } else {
+        std::vector<std::string> fields;
+        bool first = true;
+        while (result.ok && read_csv_record(in, fields)) {
+            if (first) {
+                first = false;
+                if (fields.size() >= 2 && fields[0] == "word" && fields[1] == "meaning") {
+                    continue;
+                }
+            }
+            if (fields.size() < 2) {
+                if (!(fields.size() == 1 && fields[0].empty())) {
+                    ++result.skipped;
+                }
+                continue;
+            }
+            add(std::move(fields[0]), std::move(fields[1]));
+        }
+    }
+    if (result.ok) {
+        commit();
+    }
+    
+    std::fclose(file);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,248 @@
+#include "../include/definition_prefetcher.hpp"
+#include "../include/definition_fetcher.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const size_t LATENCY_SAMPLES = 1024;
+
+double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+DefinitionPrefetcher::DefinitionPrefetcher(DictionaryDB& db, DefinitionResolver& resolver,
+                                           const PrefetchOptions& options)
+    : db(db), resolver(resolver), options(options), base_url(DefinitionFetcher::resolve_base_url(options.base_url)),
+      multi(curl_multi_init()) {
+    if (!multi) {
+        std::cerr << "Failed to initialize cURL multi handle; prefetching disabled" << std::endl;
+        return;
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(options.max_in_flight));
+    io = std::thread(&DefinitionPrefetcher::io_loop, this);
+}
+
+DefinitionPrefetcher::~DefinitionPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    idle_cv.notify_all();
+    if (io.joinable()) {
+        curl_multi_wakeup(multi);
+        io.join();
+    }
+    if (multi) {
+        curl_multi_cleanup(multi);
+    }
+}
+
+size_t DefinitionPrefetcher::prefetch(const std::vector<std::string>& words) {
+    if (!multi) {
+        return 0;
+    }
+    size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& word : words) {
+            std::string key = DefinitionResolver::normalize(word);
+            if (key.empty() || queued_words.count(key)) {
+                continue;
+            }
+            if (queue.size() >= options.queue_capacity) {
+                ++counters.dropped;
+                continue;
+            }
+            queue.push_back(key);
+            queued_words.insert(std::move(key));
+            ++added;
+        }
+        counters.queued += added;
+    }
+    if (added) {
+        curl_multi_wakeup(multi);
+    }
+    return added;
+}
+
+void DefinitionPrefetcher::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle_cv.wait(lock, [this] { return stopping || (queue.empty() && in_flight == 0); });
+}
+
+PrefetchStats DefinitionPrefetcher::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    PrefetchStats s = counters;
+    s.in_flight = in_flight;
+    s.pending = queue.size();
+    s.latency_p50_ms = percentile(latencies_ms, 0.50);
+    s.latency_p99_ms = percentile(latencies_ms, 0.99);
+    size_t completed = s.fetched + s.not_found + s.failed;
+    s.throughput = active_seconds > 0 ? completed / active_seconds : 0;
+    return s;
+}
+
+void DefinitionPrefetcher::io_loop() {
+    double tokens = options.burst;
+    auto last = std::chrono::steady_clock::now();
+
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                break;
+            }
+            if (!queue.empty() || in_flight > 0) {
+                active_seconds += elapsed;
+            }
+        }
+        tokens = std::min(options.burst, tokens + elapsed * options.requests_per_second);
+        start_transfers(tokens);
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        int remaining = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &remaining)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finish_transfer(msg->easy_handle, msg->data.result);
+            }
+        }
+
+        // Sleep until a socket is ready, prefetch() wakes us, or the bucket
+        // has a token for the next queued word. Don't sleep at all if a
+        // finished transfer freed a slot that can be used right away.
+        int timeout_ms = 1000;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!queue.empty() && in_flight < options.max_in_flight) {
+                double wait = tokens >= 1 ? 0 : (1 - tokens) / options.requests_per_second;
+                timeout_ms = static_cast<int>(std::ceil(wait * 1000));
+            }
+        }
+        curl_multi_poll(multi, nullptr, 0, timeout_ms, nullptr);
+    }
+
+    // Abandon whatever is still running; lookups waiting on it get an error
+    Resolution cancelled;
+    cancelled.error = "prefetch cancelled";
+    for (auto& transfer : active) {
+        transfer->lease->complete(cancelled);
+        curl_multi_remove_handle(multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+    }
+    active.clear();
+}
+
+void DefinitionPrefetcher::start_transfers(double& tokens) {
+    while (tokens >= 1) {
+        std::string word;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || queue.empty() || in_flight >= options.max_in_flight) {
+                return;
+            }
+            word = std::move(queue.front());
+            queue.pop_front();
+            ++in_flight;  // reserved now so wait_idle never sees a gap
+        }
+
+        auto transfer = std::make_unique<Transfer>();
+        if (!db.word_exists(word) && !db.known_missing(word)) {
+            transfer->lease = resolver.lead(word);  // nullptr if someone is looking it up
+        }
+        if (transfer->lease) {
+            transfer->easy = curl_easy_init();
+        }
+        std::string url = transfer->easy ? DefinitionFetcher::url_for(transfer->easy, base_url, word) : "";
+        if (url.empty()) {
+            if (transfer->easy) {
+                curl_easy_cleanup(transfer->easy);
+            }
+            if (transfer->lease) {
+                Resolution failed;
+                failed.error = "could not start the transfer";
+                transfer->lease->complete(failed);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (transfer->lease) {
+                ++counters.failed;
+            } else {
+                ++counters.skipped;
+            }
+            --in_flight;
+            queued_words.erase(word);
+            idle_cv.notify_all();
+            continue;
+        }
+
+        tokens -= 1;
+        transfer->word = std::move(word);
+        transfer->started = std::chrono::steady_clock::now();
+        DefinitionFetcher::configure(transfer->easy, options.timeout_ms);
+        curl_easy_setopt(transfer->easy, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(transfer->easy, CURLOPT_WRITEDATA, &transfer->body);
+        curl_easy_setopt(transfer->easy, CURLOPT_PRIVATE, transfer.get());
+        curl_multi_add_handle(multi, transfer->easy);
+        active.push_back(std::move(transfer));
+    }
+}
+
+void DefinitionPrefetcher::finish_transfer(CURL* easy, CURLcode code) {
+    Transfer* transfer = nullptr;
+    curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&transfer));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - transfer->started).count();
+
+    FetchResult result;
+    if (code == CURLE_OK) {
+        long http_status = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_status);
+        result = DefinitionFetcher::interpret(http_status, transfer->body);
+    } else {
+        result.error = curl_easy_strerror(code);
+    }
+    // Stored before the lease is released, so lookups that were waiting
+    // and the ones after them agree
+    transfer->lease->complete(resolver.store(transfer->word, result));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.ok()) {
+            ++counters.fetched;
+        } else if (result.status == FetchResult::Status::NotFound) {
+            ++counters.not_found;
+        } else {
+            ++counters.failed;
+        }
+        record_latency(ms);
+        --in_flight;
+        queued_words.erase(transfer->word);
+    }
+    idle_cv.notify_all();
+
+    curl_multi_remove_handle(multi, easy);
+    curl_easy_cleanup(easy);
+    active.erase(std::find_if(active.begin(), active.end(),
+                              [transfer](const auto& t) { return t.get() == transfer; }));
+}
+
+void DefinitionPrefetcher::record_latency(double ms) {
+    counters.latency_max_ms = std::max(counters.latency_max_ms, ms);
+    if (latencies_ms.size() < LATENCY_SAMPLES) {
+        latencies_ms.push_back(ms);
+    } else {
+        latencies_ms[latency_next] = ms;
+        latency_next = (latency_next + 1) % LATENCY_SAMPLES;
+    }
+}
@@ -0,0 +1,80 @@
+#include "../include/definition_resolver.hpp"
+#include <cctype>
+
+DefinitionResolver::DefinitionResolver(DictionaryDB& db, DefinitionFetcher& fetcher,
+                                       std::chrono::steady_clock::duration failure_window)
+    : db(db), fetcher(fetcher),
+      flights([](const Resolution& r) { return r.source == Resolution::Source::Error; }, failure_window) {}
+
+std::string DefinitionResolver::trim(const std::string& word) {
+    size_t begin = word.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = word.find_last_not_of(" \t\r\n");
+    return word.substr(begin, end - begin + 1);
+}
+
+std::string DefinitionResolver::normalize(const std::string& word) {
+    std::string key = trim(word);
+    for (char& c : key) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+Resolution DefinitionResolver::resolve(const std::string& word) {
+    std::string key = normalize(word);
+    Resolution result;
+    if (key.empty()) {
+        result.source = Resolution::Source::NotFound;
+        return result;
+    }
+
+    // Imported and hand-added words keep their case ("NASA"); fetched ones
+    // are stored under the lowercased key
+    std::string exact = trim(word);
+    result.meaning = db.get_meaning(exact);
+    if (result.meaning.empty() && exact != key) {
+        result.meaning = db.get_meaning(key);
+    }
+    if (!result.meaning.empty()) {
+        result.source = Resolution::Source::Database;
+        return result;
+    }
+    if (db.known_missing(key)) {
+        result.source = Resolution::Source::NotFound;
+        return result;
+    }
+
+    return flights.run(key, [this, &key] { return fetch_and_store(key); });
+}
+
+Resolution DefinitionResolver::fetch_and_store(const std::string& word) {
+    Resolution result;
+
+    // Another leader may have stored it between our miss and taking the flight
+    result.meaning = db.get_meaning(word);
+    if (!result.meaning.empty()) {
+        result.source = Resolution::Source::Database;
+        return result;
+    }
+
+    return store(word, fetcher.fetch(word));
+}
+
+Resolution DefinitionResolver::store(const std::string& key, const FetchResult& fetched) {
+    Resolution result;
+    if (fetched.ok()) {
+        result.source = Resolution::Source::Fetched;
+        result.meaning = DefinitionFetcher::format(key, fetched.senses);
+        db.add_word(key, result.meaning);
+    } else if (fetched.status == FetchResult::Status::NotFound) {
+        result.source = Resolution::Source::NotFound;
+        db.mark_missing(key);
+    } else {
+        result.source = Resolution::Source::Error;
+        result.error = fetched.error;
+    }
+    return result;
+}
@@ -0,0 +1,531 @@
+#include "../include/dict_server.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const size_t READ_CHUNK = 16 * 1024;
+const size_t MAX_LIMIT = 10000;
+
+void append_header(std::string& out, size_t lines) {
+    out += "OK ";
+    out += std::to_string(lines);
+    out += '\n';
+}
+
+void append_error(std::string& out, const char* reason) {
+    out += "ERR ";
+    out += reason;
+    out += '\n';
+}
+
+// Splits the next space-separated token off [p, end)
+std::string next_token(const char*& p, const char* end) {
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+    const char* start = p;
+    while (p < end && *p != ' ') {
+        ++p;
+    }
+    return std::string(start, p);
+}
+
+size_t parse_limit(const std::string& token, size_t fallback) {
+    if (token.empty() || !std::all_of(token.begin(), token.end(), ::isdigit) || token.size() > 9) {
+        return fallback;
+    }
+    return std::min<size_t>(std::stoul(token), MAX_LIMIT);
+}
+
+} // namespace
+
+DictServer::DictServer(QueryEngine& engine, const DictServerOptions& options)
+    : engine(engine), options(options) {
+    if (this->options.workers == 0) {
+        this->options.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+DictServer::~DictServer() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        workers_stopping = true;
+    }
+    queue_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& [fd, conn] : connections) {
+        close(fd);
+    }
+    for (int fd : listen_fds) {
+        close(fd);
+    }
+    if (wake_fd >= 0) {
+        close(wake_fd);
+    }
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+}
+
+bool DictServer::start() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        std::cerr << "Failed to create epoll/eventfd: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    if ((options.port > 0 && !listen_tcp()) || (!options.unix_path.empty() && !listen_unix())) {
+        return false;
+    }
+    if (listen_fds.empty()) {
+        std::cerr << "Nothing to listen on" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < options.workers; ++i) {
+        workers.emplace_back(&DictServer::worker_loop, this);
+    }
+    return true;
+}
+
+bool DictServer::listen_tcp() {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.bind_address.c_str(), &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << options.bind_address << ":" << options.port << ": "
+                  << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    listen_fds.push_back(fd);
+    return true;
+}
+
+bool DictServer::listen_unix() {
+    sockaddr_un addr{};
+    if (options.unix_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Unix socket path too long: " << options.unix_path << std::endl;
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, options.unix_path.c_str());
+    unlink(options.unix_path.c_str());  // left over from a previous run
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << options.unix_path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    listen_fds.push_back(fd);
+    return true;
+}
+
+void DictServer::stop() {
+    stop_requested.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void DictServer::run() {
+    epoll_event events[256];
+    auto deadline = std::chrono::steady_clock::time_point::max();
+
+    while (!draining || (!drained() && std::chrono::steady_clock::now() < deadline)) {
+        int n = epoll_wait(epoll_fd, events, 256, draining ? 100 : -1);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd) {
+                uint64_t count;
+                while (read(wake_fd, &count, sizeof(count)) > 0) {
+                }
+                handle_completions();
+                if (stop_requested.load() && !draining) {
+                    begin_drain();
+                    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.shutdown_grace_ms);
+                }
+                continue;
+            }
+            if (std::find(listen_fds.begin(), listen_fds.end(), fd) != listen_fds.end()) {
+                accept_all(fd);
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& c = *it->second;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                on_readable(c);
+            }
+            // on_readable may have closed it
+            it = connections.find(fd);
+            if (it != connections.end() && (events[i].events & EPOLLOUT)) {
+                flush(*it->second);
+            }
+        }
+    }
+
+    // Whatever is left did not finish within the grace period
+    std::vector<Connection*> remaining;
+    for (auto& [fd, conn] : connections) {
+        remaining.push_back(conn.get());
+    }
+    for (Connection* c : remaining) {
+        if (!c->busy) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, nullptr);
+            close(c->fd);
+            connections.erase(c->fd);
+        }
+    }
+}
+
+void DictServer::accept_all(int listen_fd) {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // fails harmlessly on Unix sockets
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        epoll_event ev{};
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        connections[fd] = std::move(conn);
+    }
+}
+
+void DictServer::on_readable(Connection& c) {
+    char buffer[READ_CHUNK];
+    while (c.in.size() < options.max_input) {
+        ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            c.in.append(buffer, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // EOF or error: answer what already arrived, then close
+        c.peer_closed = true;
+        break;
+    }
+
+    size_t last_newline = c.in.rfind('\n');
+    size_t partial = last_newline == std::string::npos ? c.in.size() : c.in.size() - last_newline - 1;
+    if (partial > options.max_line) {
+        c.in.clear();
+        append_error(c.out, "line too long");
+        c.close_after_write = true;
+        flush(c);
+        return;
+    }
+
+    int fd = c.fd;
+    dispatch(c);
+    maybe_close(c);
+    if (connections.count(fd)) {
+        update_events(c);
+    }
+}
+
+void DictServer::dispatch(Connection& c) {
+    if (c.busy || c.close_after_write || c.out.size() - c.out_sent > options.max_output) {
+        return;
+    }
+    size_t last_newline = c.in.rfind('\n');
+    if (last_newline == std::string::npos) {
+        return;
+    }
+
+    // Hand every complete line to one worker; the partial tail stays
+    c.work_in.assign(c.in, 0, last_newline + 1);
+    c.in.erase(0, last_newline + 1);
+    c.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        jobs.push_back(&c);
+    }
+    queue_cv.notify_one();
+}
+
+void DictServer::flush(Connection& c) {
+    while (c.out_sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.out_sent, c.out.size() - c.out_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.out_sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // The peer is gone; nothing more can be delivered
+        c.out.clear();
+        c.out_sent = 0;
+        c.peer_closed = true;
+        c.close_after_write = true;
+        break;
+    }
+    if (c.out_sent == c.out.size()) {
+        c.out.clear();
+        c.out_sent = 0;
+    }
+
+    // Draining the output may unblock requests held back by max_output
+    int fd = c.fd;
+    dispatch(c);
+    maybe_close(c);
+    if (connections.count(fd)) {
+        update_events(c);
+    }
+}
+
+void DictServer::update_events(Connection& c) {
+    uint32_t wanted = 0;
+    if (!draining && !c.peer_closed && !c.close_after_write && c.in.size() < options.max_input) {
+        wanted |= EPOLLIN;
+    }
+    if (c.out_sent < c.out.size()) {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted == c.events) {
+        return;
+    }
+    // With no interest left the fd is taken out of the set altogether;
+    // EPOLLHUP is reported regardless of the mask and would spin the loop.
+    epoll_event ev{};
+    ev.events = wanted;
+    ev.data.fd = c.fd;
+    int op = wanted == 0 ? EPOLL_CTL_DEL : (c.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+    epoll_ctl(epoll_fd, op, c.fd, &ev);
+    c.events = wanted;
+}
+
+void DictServer::maybe_close(Connection& c) {
+    if (c.busy || c.out_sent < c.out.size()) {
+        return;
+    }
+    bool finished = c.close_after_write || (c.peer_closed && c.in.find('\n') == std::string::npos);
+    if (!finished) {
+        return;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, nullptr);
+    close(c.fd);
+    connections.erase(c.fd);  // destroys c
+}
+
+void DictServer::handle_completions() {
+    std::vector<Connection*> finished;
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        finished.swap(done);
+    }
+    for (Connection* c : finished) {
+        c->busy = false;
+        if (c->out.empty()) {
+            c->out.swap(c->work_out);  // the old buffer keeps its capacity for next time
+        } else {
+            c->out.append(c->work_out);
+        }
+        c->work_out.clear();
+        if (c->quit) {
+            c->close_after_write = true;
+        }
+        flush(*c);
+    }
+}
+
+void DictServer::begin_drain() {
+    // Stop accepting; requests already received are still answered
+    for (int fd : listen_fds) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+    }
+    listen_fds.clear();
+    if (!options.unix_path.empty()) {
+        unlink(options.unix_path.c_str());
+    }
+    draining = true;
+
+    std::vector<Connection*> all;
+    for (auto& [fd, conn] : connections) {
+        all.push_back(conn.get());
+    }
+    for (Connection* c : all) {
+        c->close_after_write = c->close_after_write || c->in.find('\n') == std::string::npos;
+        flush(*c);
+    }
+}
+
+bool DictServer::drained() const {
+    for (const auto& [fd, conn] : connections) {
+        if (conn->busy || conn->out_sent < conn->out.size() || conn->in.find('\n') != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DictServer::worker_loop() {
+    while (true) {
+        Connection* c;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return workers_stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            c = jobs.front();
+            jobs.pop_front();
+        }
+
+        execute(*c);
+
+        {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            done.push_back(c);
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void DictServer::execute(Connection& c) {
+    const char* p = c.work_in.data();
+    const char* end = p + c.work_in.size();
+    while (p < end && !c.quit) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = eol;
+        if (line_end > p && line_end[-1] == '\r') {
+            --line_end;
+        }
+        execute_line(p, line_end, c);
+        p = eol + 1;
+    }
+    c.work_in.clear();
+}
+
+void DictServer::execute_line(const char* p, const char* end, Connection& c) {
+    std::string& out = c.work_out;
+    std::string command = next_token(p, end);
+    std::transform(command.begin(), command.end(), command.begin(), ::tolower);
+    std::string arg = next_token(p, end);
+
+    if (command.empty()) {
+        append_error(out, "empty request");
+    } else if (command == "search") {
+        append_header(out, 1);
+        out += engine.search(arg) ? "1\n" : "0\n";
+    } else if (command == "prefix") {
+        auto words = engine.prefix(arg, parse_limit(next_token(p, end), 100));
+        append_header(out, words.size());
+        for (const auto& w : words) {
+            out += w;
+            out += '\n';
+        }
+    } else if (command == "suggest") {
+        auto words = engine.suggest(arg);
+        append_header(out, words.size());
+        for (const auto& w : words) {
+            out += w;
+            out += '\n';
+        }
+    } else if (command == "top") {
+        auto top = engine.top(static_cast<int>(parse_limit(arg, 10)));
+        append_header(out, top.size());
+        for (const auto& [w, f] : top) {
+            out += w;
+            out += ' ';
+            out += std::to_string(f);
+            out += '\n';
+        }
+    } else if (command == "meaning") {
+        Resolution r = engine.meaning(arg);
+        if (r.source == Resolution::Source::NotFound) {
+            append_error(out, "not_found");
+        } else if (!r.found()) {
+            append_error(out, "fetch_failed");
+        } else {
+            if (!r.meaning.empty() && r.meaning.back() == '\n') {
+                r.meaning.pop_back();
+            }
+            append_header(out, std::count(r.meaning.begin(), r.meaning.end(), '\n') + 1);
+            out += r.meaning;
+            out += '\n';
+        }
+    } else if (command == "insert") {
+        if (arg.empty()) {
+            append_error(out, "missing word");
+        } else {
+            engine.insert(arg);
+            append_header(out, 0);
+        }
+    } else if (command == "remove") {
+        if (engine.remove(arg)) {
+            append_header(out, 0);
+        } else {
+            append_error(out, "not_found");
+        }
+    } else if (command == "quit") {
+        append_header(out, 0);
+        c.quit = true;
+    } else {
+        append_error(out, "unknown command");
+    }
+}
@@ -1,6 +1,12 @@
 #include "../include/database.hpp"
-#include "../include/radix_tree.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_prefetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include "../include/layered_dictionary.hpp"
+#include "../include/metrics.hpp"
+#include "../include/query_log.hpp"
 #include "../include/ui.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
@@ -12,15 +18,104 @@
 #include <string>
 #include <vector>
 
+// Words starting with a prefix, read through a LayeredDictionary::Iterator
+// one page at a time
+class PrefixSource : public ResultSource {
+private:
+    LayeredDictionary::Iterator it;
+    std::string prefix;
+    
+    bool in_range() const {
+        return it.valid() && it.key().compare(0, prefix.size(), prefix) == 0;
+    }
+    
+    // Up to `count` words ending at the iterator, in order
+    std::vector<std::string> collect_back(size_t count) {
+        std::vector<std::string> rows;
+        for (; in_range() && rows.size() < count; it.prev()) {
+            rows.push_back(it.key());
+        }
+        std::reverse(rows.begin(), rows.end());
+        return rows;
+    }
+    
+public:
+    PrefixSource(LayeredDictionary::Iterator it, const std::string& prefix) : it(std::move(it)), prefix(prefix) {}
+    
+    std::vector<std::string> rows_from(const std::string& key, size_t count) override {
+        std::vector<std::string> rows;
+        for (it.seek(std::max(key, prefix)); in_range() && rows.size() < count; it.next()) {
+            rows.push_back(it.key());
+        }
+        return rows;
+    }
+    
+    std::vector<std::string> rows_before(const std::string& key, size_t count) override {
+        it.seek(std::max(key, prefix));
+        if (it.valid()) {
+            it.prev();
+        } else {
+            it.seekToLast();
+        }
+        return collect_back(count);
+    }
+    
+    std::vector<std::string> last_rows(size_t count) override {
+        // Seek to the first key past the prefix range: the prefix with its
+        // last character incremented
+        std::string end = prefix;
+        while (!end.empty() && (unsigned char)end.back() == 0xff) {
+            end.pop_back();
+        }
+        if (end.empty()) {
+            it.seekToLast();
+            return collect_back(count);
+        }
+        end.back()++;
+        return rows_before(end, count);
+    }
+};
+
 class DictionaryApp : public UI {
 private:
-    RadixTree tree;
+    LayeredDictionary tree;
     std::unique_ptr<DictionaryDB> db;
+    DefinitionFetcher fetcher;
+    std::unique_ptr<DefinitionResolver> resolver;
+    std::unique_ptr<DefinitionPrefetcher> prefetcher;  // uses resolver
+    // Follows the input as it is typed so each keystroke only walks one
+    // more (or one less) character; invalidated by inserts into the tree
+    LayeredDictionary::Cursor completion;
+    // Operations are captured here when $DICT_QUERY_LOG is set
+    std::unique_ptr<QueryLog> query_log;
     std::string currentUser;
     std::string userPath;
     
+    // First numbered sense of a formatted meaning, without colour codes
+    static std::string first_sense(const std::string& meaning) {
+        std::istringstream iss(meaning);
+        std::string line;
+        while (std::getline(iss, line)) {
+            std::string plain;
+            for (size_t i = 0; i < line.size(); ++i) {
+                if (line[i] == '\033') {
+                    size_t end = line.find('m', i);
+                    if (end == std::string::npos) break;
+                    i = end;
+                } else {
+                    plain += line[i];
+                }
+            }
+            if (!plain.empty() && isdigit((unsigned char)plain[0])) {
+                return plain;
+            }
+        }
+        return "";
+    }
+    
 public:
-    DictionaryApp() {
+    DictionaryApp()
+        : tree(BaseDictionary::load("assets/dictionary.txt")), completion(tree.cursor()) {
         // Initialize database
         try {
             db = std::make_unique<DictionaryDB>("dictionary.db");
@@ -30,91 +125,105 @@ public:
             exit(1);
         }
         
-        // Load initial dictionary
-        load_dictionary();
-    }
-    
-    void load_dictionary() {
-        std::string dict_path = "assets/dictionary.txt";
-        std::ifstream file(dict_path);
-        if (file.is_open()) {
-            std::string word;
-            while (std::getline(file, word)) {
-                tree.insert(word);
-            }
-        }
+        resolver = std::make_unique<DefinitionResolver>(*db, fetcher);
+        prefetcher = std::make_unique<DefinitionPrefetcher>(*db, *resolver);
+        query_log = QueryLog::from_env();
     }
     
     // Override UI callbacks
     std::vector<std::string> on_search(const std::string& query) override {
         std::vector<std::string> results;
+        QueryLog::Scope logged(query_log.get(), QueryOp::Meaning, query);
         
-        // Try to get from local database first
-        std::string meaning = db->get_meaning(query);
-        if (!meaning.empty()) {
-            // Split meaning into lines for display
-            std::istringstream iss(meaning);
-            std::string line;
-            while (std::getline(iss, line)) {
-                results.push_back(line);
-            }
-            db->record_search(query);
+        Resolution r = resolver->resolve(query);
+        if (r.source == Resolution::Source::NotFound) {
+            results.push_back("No definition found");
             return results;
         }
-        
-        // If not found locally, try online
-        std::string command = "python3 get_meaning.py \"" + query + "\"";
-        std::array<char, 128> buffer;
-        std::string result;
-        
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            results.push_back("Error: Failed to execute command");
+        if (r.source == Resolution::Source::Error) {
+            results.push_back("Error: Failed to get meaning from online source (" + r.error + ")");
             return results;
         }
         
-        while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-            result += buffer.data();
+        // Split meaning into lines for display
+        std::istringstream iss(r.meaning);
+        std::string line;
+        while (std::getline(iss, line)) {
+            results.push_back(line);
         }
-        
-        int status = pclose(pipe);
-        
-        if (status != 0) {
-            results.push_back("Error: Failed to get meaning from online source");
-            return results;
+        db->record_search(DefinitionResolver::normalize(query));
+        return results;
+    }
+    
+    std::string on_preview(const std::string& word) override {
+        QueryLog::Scope logged(query_log.get(), QueryOp::Preview, word);
+        Resolution r = resolver->resolve(word);
+        if (r.source == Resolution::Source::NotFound || r.source == Resolution::Source::Error) {
+            return "";
         }
-        
-        // If we got a valid response, save it to the database
-        if (!result.empty() && result.find("No definition found") == std::string::npos) {
-            db->add_word(query, result);
-            db->record_search(query);
-            
-            // Split result into lines
-            std::istringstream iss(result);
-            std::string line;
-            while (std::getline(iss, line)) {
-                results.push_back(line);
+        return first_sense(r.meaning);
+    }
+    
+    std::vector<std::string> on_complete(const std::string& input, size_t limit) override {
+        if (input.empty() || input[0] == '/') {
+            return {};
+        }
+        QueryLog::Scope logged(query_log.get(), QueryOp::Complete, input);
+        const std::string& prefix = completion.prefix();
+        if (input.size() == prefix.size() + 1 && input.compare(0, prefix.size(), prefix) == 0) {
+            completion.push(input.back());
+        } else if (input.size() + 1 == prefix.size() && prefix.compare(0, input.size(), input) == 0) {
+            completion.pop();
+        } else if (input != prefix) {
+            completion = tree.cursor();
+            for (char c : input) {
+                completion.push(c);
             }
-        } else {
-            results.push_back("No definition found");
         }
-        
-        return results;
+        return completion.complete(limit);
+    }
+    
+    std::unique_ptr<ResultSource> on_browse(const std::string& prefix) override {
+        return std::make_unique<PrefixSource>(tree.iterator(), prefix);
     }
     
     bool on_add_word(const std::string& word, const std::string& meaning) override {
+        QueryLog::Scope logged(query_log.get(), QueryOp::AddWord, word);
         if (tree.search(word)) {
             return false;  // Word already exists
         }
         
         tree.insert(word);
+        completion = tree.cursor();
         return db->add_word(word, meaning);
     }
     
+    std::vector<std::string> on_search_definitions(const std::string& query) override {
+        std::vector<std::string> results;
+        QueryLog::Scope logged(query_log.get(), QueryOp::SearchDefinitions, query);
+        for (const auto& match : db->search_definitions(query, 20)) {
+            results.push_back(match.word + ": " + match.snippet);
+        }
+        return results;
+    }
+    
+    std::string on_metrics() override {
+        return metrics::report();
+    }
+    
+    void on_quit() override {
+        prefetcher.reset();
+        db->flush();
+        if (query_log) {
+            query_log->flush();
+        }
+    }
+    
     std::string get_word_of_the_day() override {
         // Simple implementation - just return the first word for now
         auto words = tree.starts_with("");
         if (!words.empty()) {
+            prefetcher->prefetch({words[0]});
             return words[0];
         }
         return "";
@@ -126,6 +235,8 @@ public:
 };
 
 int main() {
+    // Declared first so the final dump sees everything the app recorded
+    auto metrics_dump = metrics::PeriodicDump::from_env();
     DictionaryApp app;
     app.run();
     return 0;
@@ -0,0 +1,311 @@
+#include "../include/json.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace json {
+
+namespace {
+
+class Parser {
+private:
+    const char* p;
+    const char* end;
+    std::string error;
+    int depth = 0;
+
+    static constexpr int MAX_DEPTH = 256;
+
+    bool fail(const char* message) {
+        if (error.empty()) {
+            error = message;
+        }
+        return false;
+    }
+
+    void skip_ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::strlen(word);
+        if (static_cast<size_t>(end - p) < n || std::memcmp(p, word, n) != 0) {
+            return fail("invalid literal");
+        }
+        p += n;
+        return true;
+    }
+
+    static void append_utf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    bool hex4(unsigned& cp) {
+        if (end - p < 4) {
+            return fail("truncated \\u escape");
+        }
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = *p++;
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else return fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    bool parse_string(std::string& out) {
+        ++p;  // opening quote
+        while (true) {
+            // Copy the run of plain characters in one go
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\') {
+                ++p;
+            }
+            out.append(run, p - run);
+            if (p >= end) {
+                return fail("unterminated string");
+            }
+            if (*p == '"') {
+                ++p;
+                return true;
+            }
+            ++p;  // backslash
+            if (p >= end) {
+                return fail("unterminated string");
+            }
+            char c = *p++;
+            switch (c) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    unsigned cp;
+                    if (!hex4(cp)) {
+                        return false;
+                    }
+                    // Surrogate pair
+                    if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        p += 2;
+                        unsigned low;
+                        if (!hex4(low)) {
+                            return false;
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, cp);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+    }
+
+    bool parse_value(Value& out) {
+        skip_ws();
+        if (p >= end) {
+            return fail("unexpected end of input");
+        }
+        switch (*p) {
+            case 'n':
+                out.type = Value::Type::Null;
+                return literal("null");
+            case 't':
+                out.type = Value::Type::Bool;
+                out.boolean = true;
+                return literal("true");
+            case 'f':
+                out.type = Value::Type::Bool;
+                out.boolean = false;
+                return literal("false");
+            case '"':
+                out.type = Value::Type::String;
+                return parse_string(out.string);
+            case '[':
+                return parse_array(out);
+            case '{':
+                return parse_object(out);
+            default:
+                return parse_number(out);
+        }
+    }
+
+    bool parse_number(Value& out) {
+        // strtod needs a terminator; numbers are short, so copy them out
+        const char* start = p;
+        while (p < end && (std::strchr("+-.eE", *p) || (*p >= '0' && *p <= '9'))) {
+            ++p;
+        }
+        if (p == start) {
+            return fail("unexpected character");
+        }
+        std::string digits(start, p);
+        char* parsed_end = nullptr;
+        out.type = Value::Type::Number;
+        out.number = std::strtod(digits.c_str(), &parsed_end);
+        if (parsed_end != digits.c_str() + digits.size()) {
+            return fail("invalid number");
+        }
+        return true;
+    }
+
+    bool parse_array(Value& out) {
+        if (++depth > MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        ++p;
+        out.type = Value::Type::Array;
+        skip_ws();
+        if (p < end && *p == ']') {
+            ++p;
+            --depth;
+            return true;
+        }
+        while (true) {
+            out.array.emplace_back();
+            if (!parse_value(out.array.back())) {
+                return false;
+            }
+            skip_ws();
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == ']') {
+                ++p;
+                --depth;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool parse_object(Value& out) {
+        if (++depth > MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        ++p;
+        out.type = Value::Type::Object;
+        skip_ws();
+        if (p < end && *p == '}') {
+            ++p;
+            --depth;
+            return true;
+        }
+        while (true) {
+            skip_ws();
+            if (p >= end || *p != '"') {
+                return fail("expected member name");
+            }
+            out.object.emplace_back();
+            if (!parse_string(out.object.back().first)) {
+                return false;
+            }
+            skip_ws();
+            if (p >= end || *p != ':') {
+                return fail("expected ':'");
+            }
+            ++p;
+            if (!parse_value(out.object.back().second)) {
+                return false;
+            }
+            skip_ws();
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == '}') {
+                ++p;
+                --depth;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+public:
+    Parser(const std::string& text) : p(text.data()), end(text.data() + text.size()) {}
+
+    bool parse(Value& out, std::string* err) {
+        bool ok = parse_value(out);
+        if (ok) {
+            skip_ws();
+            if (p != end) {
+                ok = fail("trailing characters");
+            }
+        }
+        if (!ok && err) {
+            *err = error;
+        }
+        return ok;
+    }
+};
+
+} // namespace
+
+const Value* Value::get(const std::string& key) const {
+    for (const auto& [name, value] : object) {
+        if (name == key) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+std::string Value::get_string(const std::string& key, const std::string& fallback) const {
+    const Value* v = get(key);
+    return (v && v->is_string()) ? v->string : fallback;
+}
+
+bool parse(const std::string& text, Value& out, std::string* error) {
+    out = Value();
+    return Parser(text).parse(out, error);
+}
+
+void append_quoted(std::string& out, const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out.push_back(HEX[(c >> 4) & 0xF]);
+                    out.push_back(HEX[c & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+} // namespace json
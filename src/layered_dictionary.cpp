@@ -0,0 +1,368 @@
+#include "layered_dictionary.hpp"
+#include <iterator>
+#include <limits>
+#include <mutex>
+
+namespace {
+
+// First line of every statistics file written by the overlay; files
+// without it come from before the overlay
+const char STATS_HEADER[] = "# radix_dict user stats v2";
+
+} // namespace
+
+BaseDictionary::BaseDictionary(const std::string &filename) {
+  tree.loadWords(filename);
+  ranking = tree.getTopNWords(std::numeric_limits<int>::max());
+}
+
+std::shared_ptr<const BaseDictionary>
+BaseDictionary::load(const std::string &filename) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::weak_ptr<const BaseDictionary>>
+      loaded;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &slot = loaded[filename];
+  if (auto shared = slot.lock())
+    return shared;
+  auto shared = std::make_shared<const BaseDictionary>(filename);
+  slot = shared;
+  return shared;
+}
+
+LayeredDictionary::LayeredDictionary(std::shared_ptr<const BaseDictionary> base)
+    : base(std::move(base)) {}
+
+void LayeredDictionary::dropRemoved(std::vector<std::string> &words) const {
+  if (tombstones.empty())
+    return;
+  words.erase(std::remove_if(words.begin(), words.end(),
+                             [&](const std::string &w) {
+                               return tombstones.count(w) > 0;
+                             }),
+              words.end());
+}
+
+void LayeredDictionary::insert(const std::string &key) {
+  if (base->contains(key)) {
+    tombstones.erase(key);
+  } else if (!additions.search(key)) {
+    additions.insert(key);
+    addedWords++;
+  }
+  recordUsage(key);
+}
+
+bool LayeredDictionary::search(const std::string &key) const {
+  if (additions.search(key))
+    return true;
+  return base->contains(key) && !tombstones.count(key);
+}
+
+void LayeredDictionary::remove(const std::string &key) {
+  if (additions.search(key)) {
+    additions.remove(key);
+    addedWords--;
+  } else if (base->contains(key)) {
+    tombstones.insert(key);
+  }
+}
+
+void LayeredDictionary::update(const std::string &oldKey,
+                               const std::string &newKey) {
+  remove(oldKey);
+  insert(newKey);
+}
+
+std::vector<std::string>
+LayeredDictionary::starts_with(const std::string &prefix) const {
+  std::vector<std::string> words = base->words().starts_with(prefix);
+  dropRemoved(words);
+  // The layers are disjoint: words already in the base never go to additions
+  for (auto &w : additions.starts_with(prefix))
+    words.push_back(std::move(w));
+  return words;
+}
+
+std::vector<std::string>
+LayeredDictionary::suggest(const std::string &word, int max_distance) const {
+  std::vector<std::string> words = base->words().suggest(word, max_distance);
+  dropRemoved(words);
+  for (auto &w : additions.suggest(word, max_distance))
+    words.push_back(std::move(w));
+  // Each layer ranks by its own counts; rank the merged list by this user's
+  std::vector<std::pair<int, std::string>> ranked;
+  ranked.reserve(words.size());
+  for (auto &w : words)
+    ranked.emplace_back(-getWordInfo(w).frequency, std::move(w));
+  std::sort(ranked.begin(), ranked.end());
+  words.clear();
+  for (auto &[freq, w] : ranked)
+    words.push_back(std::move(w));
+  return words;
+}
+
+void LayeredDictionary::recordUsage(const std::string &word) {
+  auto &info = wordStats[word];
+  info.frequency++;
+  info.lastAccessTime = std::time(nullptr);
+}
+
+void LayeredDictionary::loadStats(const std::string &filename) {
+  std::ifstream in(filename);
+  if (!in)
+    return;
+  wordStats.clear();
+  std::string line;
+  bool overlayFormat = false;
+  bool first = true;
+  while (std::getline(in, line)) {
+    if (first) {
+      first = false;
+      if (line == STATS_HEADER) {
+        overlayFormat = true;
+        continue;
+      }
+    }
+    std::istringstream iss(line);
+    std::string w;
+    int freq;
+    long t;
+    if (iss >> w >> freq >> t)
+      wordStats[w] = {freq, (time_t)t};
+  }
+  in.close();
+  if (!overlayFormat && migrateLegacyStats())
+    saveStats(filename);
+}
+
+// Before the overlay, every login reloaded the dictionary into a private
+// tree, adding each word's base count to its frequency, and saved every
+// word. Such a file lists every base word, and a word the user never
+// looked up holds exactly logins * base count, so the smallest quotient is
+// the number of logins; subtracting that many reloads leaves the user's
+// usage, and words with none left are dropped instead of being counted
+// twice. A file missing base words is left as it is: trimming it on a
+// wrong login count would wipe real usage.
+bool LayeredDictionary::migrateLegacyStats() {
+  const auto &ranking = base->byFrequency();
+  if (ranking.empty())
+    return false;
+  int logins = std::numeric_limits<int>::max();
+  for (auto &[word, freq] : ranking) {
+    auto it = wordStats.find(word);
+    if (it == wordStats.end())
+      return false;
+    if (freq > 0)
+      logins = std::min(logins, it->second.frequency / freq);
+  }
+  if (logins == std::numeric_limits<int>::max())
+    return false;
+  for (auto it = wordStats.begin(); it != wordStats.end();) {
+    it->second.frequency -= logins * base->frequency(it->first);
+    if (it->second.frequency <= 0)
+      it = wordStats.erase(it);
+    else
+      ++it;
+  }
+  wordStats.rehash(0);
+  return true;
+}
+
+void LayeredDictionary::saveStats(const std::string &filename) const {
+  std::ofstream out(filename);
+  out << STATS_HEADER << "\n";
+  for (auto &p : wordStats) {
+    out << p.first << " " << p.second.frequency << " "
+        << p.second.lastAccessTime << "\n";
+  }
+}
+
+void LayeredDictionary::loadWords(const std::string &filename) {
+  std::ifstream in(filename);
+  if (!in)
+    return;
+  std::string w;
+  while (in >> w)
+    insert(w);
+}
+
+std::vector<std::pair<std::string, int>>
+LayeredDictionary::getTopNWords(int N) const {
+  if (N <= 0)
+    return {};
+  size_t n = (size_t)N;
+  // Words this user touched get their merged frequency. Every other word
+  // only has its base frequency, so the first n of those in the base
+  // ranking are the only ones that can make the cut.
+  std::vector<std::pair<std::string, int>> candidates;
+  for (auto &[word, info] : wordStats) {
+    if (search(word))
+      candidates.emplace_back(word, base->frequency(word) + info.frequency);
+  }
+  size_t fromBase = 0;
+  for (auto &[word, freq] : base->byFrequency()) {
+    if (fromBase == n)
+      break;
+    if (wordStats.count(word) || tombstones.count(word))
+      continue;
+    candidates.emplace_back(word, freq);
+    fromBase++;
+  }
+  n = std::min(n, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + n,
+                    candidates.end(), [](auto &a, auto &b) {
+                      return a.second > b.second;
+                    });
+  candidates.resize(n);
+  return candidates;
+}
+
+WordInfo LayeredDictionary::getWordInfo(const std::string &word) const {
+  WordInfo info = base->words().getWordInfo(word);
+  auto it = wordStats.find(word);
+  if (it != wordStats.end()) {
+    info.frequency += it->second.frequency;
+    info.lastAccessTime = std::max(info.lastAccessTime,
+                                   it->second.lastAccessTime);
+  }
+  return info;
+}
+
+void LayeredDictionary::forEachByFrequency(
+    const std::function<bool(const std::string &, const WordInfo &)> &fn)
+    const {
+  std::vector<std::pair<std::string, WordInfo>> touched;
+  for (auto &p : wordStats) {
+    if (search(p.first))
+      touched.emplace_back(p.first, getWordInfo(p.first));
+  }
+  std::stable_sort(touched.begin(), touched.end(), [](auto &a, auto &b) {
+    return a.second.frequency > b.second.frequency;
+  });
+  // Every base word is ranked (inserting a word records its usage), so
+  // merging the two sequences covers the whole dictionary
+  size_t next = 0;
+  for (auto &[word, freq] : base->byFrequency()) {
+    if (wordStats.count(word) || tombstones.count(word))
+      continue;
+    for (; next < touched.size() && touched[next].second.frequency > freq;
+         ++next) {
+      if (!fn(touched[next].first, touched[next].second))
+        return;
+    }
+    if (!fn(word, base->words().getWordInfo(word)))
+      return;
+  }
+  for (; next < touched.size(); ++next) {
+    if (!fn(touched[next].first, touched[next].second))
+      return;
+  }
+}
+
+size_t LayeredDictionary::memoryUsage() const {
+  // Same libstdc++ model as RadixTree::memoryUsage
+  const size_t sso = 15;
+  size_t bytes = sizeof(*this) + additions.memoryUsage();
+  bytes += tombstones.bucket_count() * sizeof(void *);
+  for (auto &w : tombstones) {
+    bytes += sizeof(void *) + sizeof(size_t) + sizeof(w);
+    if (w.size() > sso)
+      bytes += w.capacity() + 1;
+  }
+  bytes += wordStats.bucket_count() * sizeof(void *);
+  for (auto &p : wordStats) {
+    bytes += sizeof(void *) + sizeof(size_t) + sizeof(p);
+    if (p.first.size() > sso)
+      bytes += p.first.capacity() + 1;
+  }
+  return bytes;
+}
+
+RadixTree LayeredDictionary::materialize() const {
+  RadixTree tree;
+  for (auto &w : starts_with(""))
+    tree.insert(w);
+  return tree;
+}
+
+std::vector<std::string>
+LayeredDictionary::Cursor::complete(size_t limit) const {
+  // Ask the base for enough extra words to cover any tombstoned ones
+  std::vector<std::string> words =
+      baseCursor.complete(limit + owner->tombstones.size());
+  owner->dropRemoved(words);
+  std::vector<std::string> added = addedCursor.complete(limit);
+  std::vector<std::string> merged;
+  std::merge(words.begin(), words.end(), added.begin(), added.end(),
+             std::back_inserter(merged));
+  if (merged.size() > limit)
+    merged.resize(limit);
+  return merged;
+}
+
+// Moves onto the lower (or higher) of the two layers' current words
+void LayeredDictionary::Iterator::pick(bool lowest) {
+  const RadixTree::Iterator *best = nullptr;
+  for (const RadixTree::Iterator *it : {&baseIt, &addedIt}) {
+    if (!it->valid())
+      continue;
+    if (!best || (lowest ? it->key() < best->key() : it->key() > best->key()))
+      best = it;
+  }
+  onWord = best != nullptr;
+  current = best ? best->key() : std::string();
+}
+
+void LayeredDictionary::Iterator::seek(const std::string &key) {
+  baseIt.seek(key);
+  addedIt.seek(key);
+  forward = true;
+  pick(true);
+  if (onWord && removed())
+    next();
+}
+
+void LayeredDictionary::Iterator::seekToLast() {
+  baseIt.seekToLast();
+  addedIt.seekToLast();
+  forward = false;
+  pick(false);
+  if (onWord && removed())
+    prev();
+}
+
+void LayeredDictionary::Iterator::next() {
+  while (onWord) {
+    for (RadixTree::Iterator *it : {&baseIt, &addedIt}) {
+      if (!forward)
+        it->seek(current);
+      if (it->valid() && it->key() == current)
+        it->next();
+    }
+    forward = true;
+    pick(true);
+    if (!onWord || !removed())
+      return;
+  }
+}
+
+void LayeredDictionary::Iterator::prev() {
+  while (onWord) {
+    for (RadixTree::Iterator *it : {&baseIt, &addedIt}) {
+      if (forward) {
+        it->seek(current);
+        if (it->valid())
+          it->prev();
+        else
+          it->seekToLast();
+      } else if (it->valid() && it->key() == current) {
+        it->prev();
+      }
+    }
+    forward = false;
+    pick(false);
+    if (!onWord || !removed())
+      return;
+  }
+}
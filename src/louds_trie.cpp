@@ -0,0 +1,335 @@
+#include "louds_trie.hpp"
+#include <cstring>
+#include <deque>
+
+namespace {
+
+const char LOUDS_MAGIC[8] = {'R', 'D', 'X', 'L', 'O', 'U', 'D', '1'};
+
+template <typename T>
+void writeArray(std::ostream &out, const std::vector<T> &v) {
+  uint64_t n = v.size();
+  out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  out.write(reinterpret_cast<const char *>(v.data()), n * sizeof(T));
+}
+
+template <typename T> bool readArray(std::istream &in, std::vector<T> &v) {
+  uint64_t n = 0;
+  if (!in.read(reinterpret_cast<char *>(&n), sizeof(n)))
+    return false;
+  // Check the count against what is left of the stream before allocating,
+  // so a corrupt length fails the load instead of exhausting memory
+  std::streampos here = in.tellg();
+  if (here < 0 || !in.seekg(0, std::ios::end))
+    return false;
+  std::streampos end = in.tellg();
+  in.seekg(here);
+  if (end < here || n > uint64_t(end - here) / sizeof(T))
+    return false;
+  v.resize(n);
+  return (bool)in.read(reinterpret_cast<char *>(v.data()), n * sizeof(T));
+}
+
+bool lessByte(char a, char b) {
+  return static_cast<unsigned char>(a) < static_cast<unsigned char>(b);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- BitVector
+
+void BitVector::push_back(bool bit) {
+  if (nbits % 64 == 0)
+    words.push_back(0);
+  if (bit)
+    words.back() |= uint64_t(1) << (nbits % 64);
+  ++nbits;
+}
+
+void BitVector::buildIndex() {
+  superRanks.assign(words.size() / 8 + 1, 0);
+  uint32_t ones = 0;
+  for (size_t w = 0; w < words.size(); ++w) {
+    if (w % 8 == 0)
+      superRanks[w / 8] = ones;
+    ones += __builtin_popcountll(words[w]);
+  }
+  if (words.size() % 8 == 0)
+    superRanks[words.size() / 8] = ones;
+}
+
+size_t BitVector::rank1(size_t i) const {
+  size_t w = i / 64;
+  size_t r = superRanks[w / 8];
+  for (size_t k = w / 8 * 8; k < w; ++k)
+    r += __builtin_popcountll(words[k]);
+  if (i % 64)
+    r += __builtin_popcountll(words[w] & ((uint64_t(1) << (i % 64)) - 1));
+  return r;
+}
+
+size_t BitVector::select0(size_t k) const {
+  // Last superblock with fewer than k zeros before it
+  size_t lo = 0, hi = superRanks.size() - 1;
+  while (lo < hi) {
+    size_t mid = (lo + hi + 1) / 2;
+    if (mid * 512 - superRanks[mid] < k)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  size_t remaining = k - (lo * 512 - superRanks[lo]);
+  size_t w = lo * 8;
+  while (true) {
+    size_t zeros = 64 - __builtin_popcountll(words[w]);
+    if (remaining <= zeros)
+      break;
+    remaining -= zeros;
+    ++w;
+  }
+  uint64_t inv = ~words[w];
+  for (size_t r = 1; r < remaining; ++r)
+    inv &= inv - 1; // drop lowest zero
+  return w * 64 + __builtin_ctzll(inv);
+}
+
+size_t BitVector::memoryUsage() const {
+  return words.capacity() * sizeof(uint64_t) +
+         superRanks.capacity() * sizeof(uint32_t);
+}
+
+void BitVector::save(std::ostream &out) const {
+  uint64_t n = nbits;
+  out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  writeArray(out, words);
+}
+
+bool BitVector::load(std::istream &in) {
+  uint64_t n = 0;
+  if (!in.read(reinterpret_cast<char *>(&n), sizeof(n)) ||
+      !readArray(in, words) || words.size() != (n + 63) / 64)
+    return false;
+  // rank1 counts whole words, so bits past the end must be clear
+  if (n % 64 != 0 && (words.back() >> (n % 64)) != 0)
+    return false;
+  nbits = n;
+  buildIndex();
+  return true;
+}
+
+// ---------------------------------------------------------------- LoudsTrie
+
+LoudsTrie::LoudsTrie() {
+  // Empty trie: super-root "10" and a childless root
+  louds.push_back(true);
+  louds.push_back(false);
+  louds.push_back(false);
+  louds.buildIndex();
+  terminal.push_back(false);
+  terminal.buildIndex();
+  hasTail.push_back(false);
+  hasTail.buildIndex();
+  firstChar.push_back('\0');
+  tailOffsets.push_back(0);
+}
+
+LoudsTrie LoudsTrie::build(const RadixTree &tree) {
+  std::vector<std::string> words = tree.starts_with("");
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  // Each node owns the sorted range of words below it; `depth` is the
+  // number of characters consumed on the way down. Nodes are visited in
+  // BFS order, which is also their id order.
+  struct Pending {
+    size_t lo, hi, depth;
+  };
+  LoudsTrie trie;
+  trie.louds = BitVector();
+  trie.terminal = BitVector();
+  trie.hasTail = BitVector();
+  trie.firstChar.assign(1, '\0');
+  trie.hasTail.push_back(false);
+  trie.numWords = words.size();
+
+  std::deque<Pending> queue{{0, words.size(), 0}};
+  trie.louds.push_back(true);
+  trie.louds.push_back(false);
+  while (!queue.empty()) {
+    Pending node = queue.front();
+    queue.pop_front();
+    size_t i = node.lo;
+    bool ends = i < node.hi && words[i].size() == node.depth;
+    trie.terminal.push_back(ends);
+    if (ends)
+      ++i;
+    while (i < node.hi) {
+      char c = words[i][node.depth];
+      size_t j = i + 1;
+      while (j < node.hi && words[j][node.depth] == c)
+        ++j;
+      // The group shares everything up to the common prefix of its first and
+      // last words; a word ending early is always the first of the range.
+      const std::string &a = words[i], &b = words[j - 1];
+      size_t end = node.depth + 1;
+      while (end < a.size() && end < b.size() && a[end] == b[end])
+        ++end;
+      trie.louds.push_back(true);
+      trie.firstChar.push_back(c);
+      trie.hasTail.push_back(end - node.depth > 1);
+      if (end - node.depth > 1) {
+        trie.tails.insert(trie.tails.end(), a.begin() + node.depth + 1,
+                          a.begin() + end);
+        trie.tailOffsets.push_back(trie.tails.size());
+      }
+      queue.push_back({i, j, end});
+      i = j;
+    }
+    trie.louds.push_back(false);
+  }
+  trie.louds.buildIndex();
+  trie.terminal.buildIndex();
+  trie.hasTail.buildIndex();
+  return trie;
+}
+
+void LoudsTrie::children(size_t node, size_t &first, size_t &count) const {
+  size_t p = louds.select0(node + 1) + 1;
+  first = louds.rank1(p);
+  count = 0;
+  while (p + count < louds.size() && louds[p + count])
+    ++count;
+}
+
+size_t LoudsTrie::findChild(size_t node, char c) const {
+  size_t first, count;
+  children(node, first, count);
+  auto begin = firstChar.begin() + first, end = begin + count;
+  auto it = std::lower_bound(begin, end, c, lessByte);
+  if (it == end || *it != c)
+    return 0; // the root is never anyone's child
+  return it - firstChar.begin();
+}
+
+const char *LoudsTrie::tailData(size_t node) const {
+  return tails.data() + tailOffsets[hasTail.rank1(node)];
+}
+
+size_t LoudsTrie::labelSize(size_t node) const {
+  if (!hasTail[node])
+    return 1;
+  size_t t = hasTail.rank1(node);
+  return 1 + tailOffsets[t + 1] - tailOffsets[t];
+}
+
+void LoudsTrie::appendLabel(size_t node, std::string &out) const {
+  out.push_back(firstChar[node]);
+  if (hasTail[node])
+    out.append(tailData(node), labelSize(node) - 1);
+}
+
+bool LoudsTrie::search(const std::string &key) const {
+  size_t node = 0, pos = 0;
+  while (pos < key.size()) {
+    node = findChild(node, key[pos]);
+    if (node == 0)
+      return false;
+    size_t len = labelSize(node);
+    if (len > 1 && (key.size() - pos < len ||
+                    std::memcmp(key.data() + pos + 1, tailData(node),
+                                len - 1) != 0))
+      return false;
+    pos += len;
+  }
+  return terminal[node];
+}
+
+void LoudsTrie::collect_words(size_t node, std::string &prefix,
+                              std::vector<std::string> &words) const {
+  if (terminal[node])
+    words.push_back(prefix);
+  size_t first, count;
+  children(node, first, count);
+  for (size_t c = first; c < first + count; ++c) {
+    size_t before = prefix.size();
+    appendLabel(c, prefix);
+    collect_words(c, prefix, words);
+    prefix.resize(before);
+  }
+}
+
+std::vector<std::string>
+LoudsTrie::starts_with(const std::string &prefix) const {
+  std::vector<std::string> results;
+  std::string path;
+  size_t node = 0, pos = 0;
+  while (pos < prefix.size()) {
+    node = findChild(node, prefix[pos]);
+    if (node == 0)
+      return results;
+    std::string label;
+    appendLabel(node, label);
+    size_t n = std::min(label.size(), prefix.size() - pos);
+    if (prefix.compare(pos, n, label, 0, n) != 0)
+      return results;
+    path += label;
+    pos += label.size();
+  }
+  collect_words(node, path, results);
+  return results;
+}
+
+void LoudsTrie::loadInto(RadixTree &tree) const {
+  for (auto &w : starts_with(""))
+    tree.insert(w);
+}
+
+size_t LoudsTrie::memoryUsage() const {
+  return louds.memoryUsage() + terminal.memoryUsage() +
+         hasTail.memoryUsage() + firstChar.capacity() + tails.capacity() +
+         tailOffsets.capacity() * sizeof(uint32_t);
+}
+
+bool LoudsTrie::save(const std::string &filename) const {
+  std::ofstream out(filename, std::ios::binary);
+  if (!out)
+    return false;
+  out.write(LOUDS_MAGIC, sizeof(LOUDS_MAGIC));
+  uint64_t n = numWords;
+  out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  louds.save(out);
+  terminal.save(out);
+  hasTail.save(out);
+  writeArray(out, firstChar);
+  writeArray(out, tails);
+  writeArray(out, tailOffsets);
+  return (bool)out;
+}
+
+bool LoudsTrie::load(const std::string &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  char magic[sizeof(LOUDS_MAGIC)];
+  uint64_t n = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, LOUDS_MAGIC, sizeof(magic)) != 0 ||
+      !in.read(reinterpret_cast<char *>(&n), sizeof(n)))
+    return false;
+
+  LoudsTrie t;
+  t.numWords = n;
+  if (!t.louds.load(in) || !t.terminal.load(in) || !t.hasTail.load(in) ||
+      !readArray(in, t.firstChar) || !readArray(in, t.tails) ||
+      !readArray(in, t.tailOffsets))
+    return false;
+
+  // Every node but the root is one child bit, plus the super-root's
+  size_t nodes = t.terminal.size();
+  if (nodes == 0 || t.louds.size() != 2 * nodes + 1 ||
+      t.louds.rank1(t.louds.size()) != nodes ||
+      t.hasTail.size() != nodes || t.firstChar.size() != nodes ||
+      t.tailOffsets.size() != t.hasTail.rank1(nodes) + 1 ||
+      t.tailOffsets.back() != t.tails.size())
+    return false;
+  *this = std::move(t);
+  return true;
+}
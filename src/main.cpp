@@ -1,5 +1,18 @@
 #include "../include/radix_tree.hpp"
+#include "../include/batch_runner.hpp"
+#include "../include/bookmark_store.hpp"
 #include "../include/database.hpp"
+#include "../include/dawg.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_import.hpp"
+#include "../include/definition_prefetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include "../include/layered_dictionary.hpp"
+#include "../include/louds_trie.hpp"
+#include "../include/metrics.hpp"
+#include "../include/query_engine.hpp"
+#include "../include/query_log.hpp"
+#include "../include/stats_export.hpp"
 #include <chrono>
 #include <memory>
 #include <array>
@@ -7,10 +20,12 @@
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <random>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <curl/curl.h>
@@ -47,9 +62,20 @@ const std::string BOLD_GREEN = "\033[1;32m";
 
 std::string currentUser;
 std::string userPath;
-std::unordered_map<std::string, std::string> bookmarks;
+BookmarkStore bookmarks;
 UserManager userManager;
 std::unique_ptr<DictionaryDB> db;
+std::unique_ptr<DefinitionFetcher> fetcher;
+std::unique_ptr<DefinitionPrefetcher> prefetcher;
+std::unique_ptr<DefinitionResolver> resolver;
+// Set from $DICT_QUERY_LOG to capture what the user does for radix_replay
+std::unique_ptr<QueryLog> queryLog;
+
+// Runs `fn`, appending it to the query log when capture is on
+template <typename F> auto logged(QueryOp op, const std::string &key, F &&fn) {
+  QueryLog::Scope scope(queryLog.get(), op, key);
+  return fn();
+}
 
 static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     ((std::string*)userp)->append((char*)contents, size * nmemb);
@@ -86,49 +112,39 @@ std::string fetchRandomWord() {
     return randomWord;
 }
 
-void getMeaningFromPython(const std::string &word) {
-    // Try to get meaning from local database first
-    std::string meaning = db->get_meaning(word);
-    
-    if (!meaning.empty()) {
-        std::cout << GREEN << "From local database:" << RESET << "\n" << meaning << "\n";
-        db->record_search(word);
-        return;
-    }
-    
-    // If not found locally, try online API
-    std::string command = "python3 get_meaning.py \"" + word + "\"";
-    
-    // Capture the output
-    std::array<char, 128> buffer;
-    std::string result;
-    
-    FILE* pipe = popen(command.c_str(), "r");
-    if (!pipe) {
-        std::cerr << RED << "Failed to execute command" << RESET << "\n";
-        return;
-    }
-    
-    // Read the output
-    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-        result += buffer.data();
-    }
-    
-    int status = pclose(pipe);
-    
-    if (status != 0) {
-        std::cerr << RED << "Failed to get meaning for '" << word << "'." << RESET << "\n";
-        return;
-    }
-    
-    // If we got a valid response, save it to the local database
-    if (!result.empty() && result.find("No definition found") == std::string::npos) {
-        db->add_word(word, result);
-        db->record_search(word);
+void getMeaning(const std::string &word) {
+    QueryLog::Scope scope(queryLog.get(), QueryOp::Meaning, word);
+    Resolution r = resolver->resolve(word);
+    switch (r.source) {
+    case Resolution::Source::Database:
+        std::cout << GREEN << "From local database:" << RESET << "\n" << r.meaning << "\n";
+        db->record_search(DefinitionResolver::normalize(word));
+        break;
+    case Resolution::Source::Fetched:
+        db->record_search(DefinitionResolver::normalize(word));
+        std::cout << r.meaning;
+        std::cout << "------------------------------------\n";
+        break;
+    case Resolution::Source::NotFound:
+        std::cerr << RED << "No definition found for '" << word << "'." << RESET << "\n";
+        break;
+    case Resolution::Source::Error:
+        std::cerr << RED << "Failed to get meaning for '" << word << "': " << r.error << RESET << "\n";
+        break;
     }
-    
-    std::cout << result;
-    std::cout << "------------------------------------\n";
+}
+
+// Starts fetching meanings for the most used of the completions just shown
+void prefetchCompletions(const LayeredDictionary &tree, std::vector<std::string> words,
+                         size_t top_k = 5) {
+  size_t k = std::min(top_k, words.size());
+  std::partial_sort(words.begin(), words.begin() + k, words.end(),
+                    [&](const std::string &a, const std::string &b) {
+                      return tree.getWordInfo(a).frequency >
+                             tree.getWordInfo(b).frequency;
+                    });
+  words.resize(k);
+  prefetcher->prefetch(words);
 }
 
 std::string timeToStr(time_t t) {
@@ -139,25 +155,13 @@ std::string timeToStr(time_t t) {
   return std::string(buf);
 }
 
-void loadBookmarks(const std::string &path) {
-  std::ifstream file(path);
-  if (!file)
-    return; // File might not exist on first run
-
-  std::string line, word, note;
-  while (std::getline(file, line)) {
-    std::stringstream ss(line);
-    if (std::getline(ss, word, '|') && std::getline(ss, note)) {
-      bookmarks[word] = note;
-    }
-  }
-}
-
-void saveBookmarks(const std::string &path) {
-  std::ofstream file(path);
-  for (const auto &[word, note] : bookmarks) {
-    file << word << "|" << note << "\n";
-  }
+std::string cleanInput(const std::string& input) {
+    std::string result = input;
+    // Remove carriage returns (\r)
+    result.erase(std::remove(result.begin(), result.end(), '\r'), result.end());
+    // Trim trailing whitespace
+    result.erase(result.find_last_not_of(" \n\t\r") + 1);
+    return result;
 }
 
 void addBookmark() {
@@ -173,33 +177,90 @@ void addBookmark() {
   std::cout << CYAN << "Enter a note for this bookmark (optional): " << RESET;
   std::getline(std::cin, note);
 
-  bookmarks[word] = note;
+  if (!bookmarks.add(word, note)) {
+    std::cout << RED << "Bookmark for '" << word << "' could not be saved."
+              << RESET << std::endl;
+    return;
+  }
   std::cout << GREEN << "Bookmark added for '" << word << "'." << RESET
             << std::endl;
 }
 
+// Lists bookmarks under a prefix one page at a time; "~word" searches the
+// bookmarked words for close spellings instead
 void viewBookmarks() {
   if (bookmarks.empty()) {
     std::cout << YELLOW << "You have no bookmarks yet." << RESET << std::endl;
     return;
   }
 
-  std::cout << BOLD_YELLOW << "\n--- Your Bookmarks ---" << RESET << std::endl;
-  for (const auto &[word, note] : bookmarks) {
-    std::cout << CYAN << "Word: " << RESET << word << std::endl;
-    std::cout << CYAN << "Note: " << RESET
-              << (note.empty() ? "(No note)" : note) << std::endl;
-    std::cout << "------------------------" << std::endl;
+  std::string prefix;
+  std::cout << CYAN << "Show bookmarks starting with (Enter for all, ~word "
+               "for similar words): "
+            << RESET;
+  std::getline(std::cin, prefix);
+  prefix = cleanInput(prefix);
+
+  if (!prefix.empty() && prefix[0] == '~') {
+    auto matches = bookmarks.fuzzy(prefix.substr(1));
+    if (matches.empty()) {
+      std::cout << YELLOW << "No bookmarked words close to '"
+                << prefix.substr(1) << "'." << RESET << std::endl;
+      return;
+    }
+    std::cout << BOLD_YELLOW << "\n--- Similar Bookmarks ---" << RESET
+              << std::endl;
+    for (const auto &word : matches) {
+      const std::string *note = bookmarks.find(word);
+      std::cout << CYAN << "Word: " << RESET << word << std::endl;
+      std::cout << CYAN << "Note: " << RESET
+                << (note->empty() ? "(No note)" : *note) << std::endl;
+      std::cout << "------------------------" << std::endl;
+    }
+    return;
+  }
+
+  const size_t pageSize = 20;
+  size_t total = bookmarks.count(prefix);
+  if (total == 0) {
+    std::cout << YELLOW << "No bookmarks start with '" << prefix << "'."
+              << RESET << std::endl;
+    return;
+  }
+  size_t pages = (total + pageSize - 1) / pageSize;
+  size_t page = 0;
+  while (true) {
+    std::cout << BOLD_YELLOW << "\n--- Your Bookmarks (page " << page + 1
+              << " of " << pages << ", " << total << " total) ---" << RESET
+              << std::endl;
+    for (const auto &[word, note] :
+         bookmarks.list(prefix, page * pageSize, pageSize)) {
+      std::cout << CYAN << "Word: " << RESET << word << std::endl;
+      std::cout << CYAN << "Note: " << RESET
+                << (note.empty() ? "(No note)" : note) << std::endl;
+      std::cout << "------------------------" << std::endl;
+    }
+    if (pages == 1)
+      return;
+    std::string cmd;
+    std::cout << CYAN << "[n]ext, [p]revious, [q]uit: " << RESET;
+    if (!std::getline(std::cin, cmd))
+      return;
+    cmd = cleanInput(cmd);
+    if (cmd == "n" && page + 1 < pages)
+      page++;
+    else if (cmd == "p" && page > 0)
+      page--;
+    else if (cmd != "n" && cmd != "p")
+      return;
   }
 }
-
 void removeBookmark() {
   std::string word;
   std::cout << CYAN << "Enter the word to remove from bookmarks: " << RESET;
   std::getline(std::cin, word);
 
-  if (bookmarks.count(word)) {
-    bookmarks.erase(word);
+  if (bookmarks.remove(word)) {
     std::cout << GREEN << "Bookmark for '" << word << "' removed." << RESET
               << std::endl;
   } else {
@@ -208,24 +269,119 @@ void removeBookmark() {
   }
 }
 
-void exportStatsToCSV(const RadixTree &tree, const std::string &path) {
-  std::ofstream out(path);
-  if (!out) {
-    std::cerr << RED << "Failed to open export.csv for writing." << RESET
+void exportStats(const LayeredDictionary &tree, const std::string &userPath) {
+  std::string choice;
+  std::cout << CYAN << "Format [c]sv, [j]sonl or [b]inary columnar (default csv): "
+            << RESET;
+  std::getline(std::cin, choice);
+  choice = cleanInput(choice);
+  ExportOptions options;
+  std::string path = userPath + "export.csv";
+  if (choice == "j" || choice == "jsonl") {
+    options.format = ExportFormat::JSONL;
+    path = userPath + "export.jsonl";
+  } else if (choice == "b" || choice == "binary") {
+    options.format = ExportFormat::Columnar;
+    path = userPath + "export.bin";
+  }
+  std::cout << CYAN << "Order [a]lphabetical or by [f]requency (default a): "
+            << RESET;
+  std::getline(std::cin, choice);
+  if (cleanInput(choice) == "f")
+    options.order = ExportOrder::Frequency;
+
+  StatsExporter exporter(options);
+  ExportStats stats;
+  if (!exporter.run(tree, path, &stats)) {
+    std::cerr << RED << "Failed to export to '" << path << "'." << RESET
               << "\n";
     return;
   }
+  std::cout << GREEN << "Exported " << stats.rows << " words to '" << path
+            << "' (" << stats.bytes / 1024 << " KB in " << std::fixed
+            << std::setprecision(1) << stats.seconds * 1000 << " ms)" << RESET
+            << "\n";
+}
 
-  out << "Word,Frequency,LastUsed\n";
-  const auto &stats = tree.getTopNWords(std::numeric_limits<int>::max());
-  for (const auto &[word, freq] : stats) {
-    out << word << "," << freq << "," << "N/A" << "\n";
-  }
+void showCompactReport(const LayeredDictionary &layered,
+                       const std::string &userPath) {
+  RadixTree tree = layered.materialize();
+  auto start = std::chrono::steady_clock::now();
+  Dawg dawg = Dawg::build(tree);
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+
+  LoudsTrie louds = LoudsTrie::build(tree);
+
+  size_t treeBytes = tree.memoryUsage();
+  size_t dawgBytes = dawg.memoryUsage();
+  size_t loudsBytes = louds.memoryUsage();
+
+  // Round-trip the LOUDS image through the user's directory for its size
+  // on disk and the time a deployment would take to load it
+  std::string imagePath = userPath + "dictionary.louds";
+  LoudsTrie reloaded;
+  bool saved = louds.save(imagePath);
+  start = std::chrono::steady_clock::now();
+  bool loaded = saved && reloaded.load(imagePath) &&
+                reloaded.wordCount() == louds.wordCount();
+  auto loadMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  std::cout << BOLD_YELLOW << "\n--- Compact Dictionary Report ---" << RESET
+            << std::endl;
+  std::cout << "Words:            " << dawg.wordCount() << std::endl;
+  std::cout << "DAWG states:      " << dawg.stateCount() << std::endl;
+  std::cout << "DAWG edges:       " << dawg.edgeCount() << std::endl;
+  std::cout << "DAWG build time:  " << ms << " ms" << std::endl;
+  std::cout << "LOUDS nodes:      " << louds.nodeCount() << std::endl;
+  std::cout << "Radix tree bytes: " << treeBytes << std::endl;
+  std::cout << "DAWG bytes:       " << dawgBytes << std::endl;
+  std::cout << "LOUDS bytes:      " << loudsBytes << std::endl;
+  if (loaded)
+    std::cout << "LOUDS image:      " << imagePath << " ("
+              << std::filesystem::file_size(imagePath) << " bytes, loaded in "
+              << loadMs << " ms)" << std::endl;
+  else
+    std::cerr << RED << "Failed to " << (saved ? "reload " : "write ")
+              << imagePath << RESET << std::endl;
+  std::cout << "User overlay:     " << layered.addedCount() << " added, "
+            << layered.removedCount() << " removed, "
+            << layered.memoryUsage() << " bytes" << std::endl;
+  if (dawgBytes > 0 && loudsBytes > 0)
+    std::cout << GREEN << "Ratio:            " << std::fixed
+              << std::setprecision(1) << (double)treeBytes / dawgBytes
+              << "x (DAWG), " << (double)treeBytes / loudsBytes
+              << "x (LOUDS) smaller" << RESET << std::endl;
+}
 
-  std::cout << GREEN << "Exported stats to '" << path << "' successfully!"
-            << RESET << "\n";
+void showMetrics() {
+  std::cout << BOLD_YELLOW << "\n--- Runtime Metrics ---" << RESET << std::endl;
+  std::cout << metrics::report();
+  DefinitionCacheStats cache = db->cache_stats();
+  std::cout << "Definition cache:       " << cache.entries << " entries, "
+            << cache.bytes / 1024 << " KB, " << cache.evictions
+            << " evictions" << std::endl;
 }
 
+void searchDefinitions() {
+  std::string query;
+  std::cout << CYAN << "Enter words to look for in meanings: " << RESET;
+  std::getline(std::cin, query);
+
+  auto matches = logged(QueryOp::SearchDefinitions, query,
+                        [&] { return db->search_definitions(query, 10); });
+  if (matches.empty()) {
+    std::cout << RED << "No meanings match '" << query << "'." << RESET
+              << std::endl;
+    return;
+  }
+  std::cout << GREEN << "Words whose meaning matches:" << RESET << std::endl;
+  for (auto &m : matches)
+    std::cout << "- " << CYAN << m.word << RESET << ": " << m.snippet
+              << std::endl;
+}
 
 void showMenu() {
   std::cout << "\n--- Radix Tree Dictionary ---" << std::endl;
@@ -240,8 +396,12 @@ void showMenu() {
   std::cout << YELLOW << "8. View Bookmarks" << RESET << std::endl;
   std::cout << YELLOW << "9. Remove a Bookmark" << RESET << std::endl;
   std::cout << BOLD_YELLOW << "--- Other ---" << RESET << std::endl;
-  std::cout << YELLOW << "10. Export to CSV" << RESET << std::endl;
-  std::cout << YELLOW << "11. Exit" << RESET << std::endl;
+  std::cout << YELLOW << "10. Export words and stats" << RESET << std::endl;
+  std::cout << YELLOW << "11. Compact Dictionary Report" << RESET << std::endl;
+  std::cout << YELLOW << "12. Import Definitions" << RESET << std::endl;
+  std::cout << YELLOW << "13. Search Definitions" << RESET << std::endl;
+  std::cout << YELLOW << "14. Runtime Metrics" << RESET << std::endl;
+  std::cout << YELLOW << "15. Exit" << RESET << std::endl;
   std::cout << CYAN << "Enter your choice: " << RESET;
 }
 
@@ -270,16 +430,132 @@ std::string getDictionaryFile() {
   }
 }
 
-std::string cleanInput(const std::string& input) {
-    std::string result = input;
-    // Remove carriage returns (\r)
-    result.erase(std::remove(result.begin(), result.end(), '\r'), result.end());
-    // Trim trailing whitespace
-    result.erase(result.find_last_not_of(" \n\t\r") + 1);
-    return result;
+void importDefinitions() {
+  std::string path;
+  std::cout << CYAN << "Enter path of definitions file (.csv or .jsonl): "
+            << RESET;
+  std::getline(std::cin, path);
+  path = cleanInput(path);
+
+  auto result = import_definitions(
+      *db, path, [](size_t rows, size_t bytes, size_t total) {
+        std::cout << "\rImported " << rows << " rows";
+        if (total > 0)
+          std::cout << " (" << bytes * 100 / total << "%)";
+        std::cout << std::flush;
+      });
+  std::cout << std::endl;
+
+  if (!result.ok) {
+    std::cout << RED << "Import from '" << path << "' failed after "
+              << result.rows << " rows." << RESET << std::endl;
+    return;
+  }
+  std::cout << GREEN << "Imported " << result.rows << " definitions in "
+            << std::fixed << std::setprecision(2) << result.seconds << "s";
+  if (result.seconds > 0)
+    std::cout << " (" << (size_t)(result.rows / result.seconds) << " rows/s)";
+  std::cout << RESET << std::endl;
+  if (result.skipped > 0)
+    std::cout << YELLOW << "Skipped " << result.skipped << " malformed rows."
+              << RESET << std::endl;
 }
 
-int main() {
+// radix_dict --batch <file|-> [--output FILE] [--threads N] [--words FILE]
+//             [--db NAME] [--stats FILE]
+// Runs a JSONL file of operations without logging in (see batch_runner.hpp)
+int runBatch(int argc, char *argv[]) {
+  std::string input, output, stats_file;
+  std::string words_file = "assets/dictionary.txt";
+  std::string db_name = "dictionary.db";
+  BatchOptions options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--batch" && has_value) {
+      input = argv[++i];
+    } else if (arg == "--output" && has_value) {
+      output = argv[++i];
+    } else if (arg == "--threads" && has_value) {
+      options.threads = std::stoul(argv[++i]);
+    } else if (arg == "--words" && has_value) {
+      words_file = argv[++i];
+    } else if (arg == "--db" && has_value) {
+      db_name = argv[++i];
+    } else if (arg == "--stats" && has_value) {
+      stats_file = argv[++i];
+    } else {
+      std::cerr << "Usage: radix_dict --batch <file|-> [--output FILE] "
+                   "[--threads N] [--words FILE] [--db NAME] [--stats FILE]"
+                << std::endl;
+      return 1;
+    }
+  }
+  if (options.threads == 0)
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::ios::sync_with_stdio(false);
+  std::ifstream file;
+  if (input != "-") {
+    file.open(input);
+    if (!file) {
+      std::cerr << "Cannot open " << input << std::endl;
+      return 1;
+    }
+  }
+  std::ofstream out_file;
+  if (!output.empty()) {
+    out_file.open(output, std::ios::binary);
+    if (!out_file) {
+      std::cerr << "Cannot write " << output << std::endl;
+      return 1;
+    }
+  }
+
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  BatchStats stats;
+  {
+    DictionaryDBOptions db_options;
+    db_options.read_connections = options.threads;
+    DictionaryDB batch_db(db_name, db_options);
+    DefinitionFetcher batch_fetcher;
+    DefinitionResolver batch_resolver(batch_db, batch_fetcher);
+
+    RadixTree tree;
+    tree.loadWords(words_file);
+    if (!stats_file.empty())
+      tree.loadStats(stats_file);
+    QueryEngine engine(tree, batch_db, batch_resolver);
+
+    BatchRunner runner(engine, options);
+    stats = runner.run(input == "-" ? std::cin : file,
+                       output.empty() ? std::cout : out_file);
+
+    batch_db.flush();
+    if (!stats_file.empty())
+      tree.saveStats(stats_file);
+  }
+  curl_global_cleanup();
+
+  std::cerr << "batch: " << stats.operations << " operations ("
+            << stats.errors << " errors) in " << std::fixed
+            << std::setprecision(2) << stats.seconds << "s";
+  if (stats.seconds > 0)
+    std::cerr << ", " << (size_t)(stats.operations / stats.seconds)
+              << " ops/s";
+  std::cerr << "; latency us p50 " << std::setprecision(1) << stats.p50_us
+            << " p99 " << stats.p99_us << " max " << stats.max_us
+            << std::endl;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  // Optional metrics file, rewritten periodically and on exit
+  auto metricsDump = metrics::PeriodicDump::from_env();
+
+  if (argc > 1)
+    return runBatch(argc, argv);
+
   // Initialize database
   try {
     db = std::make_unique<DictionaryDB>("dictionary.db");
@@ -390,16 +666,24 @@ int main() {
     }
   }
 
-  // At this point, user is authenticated
-  RadixTree tree;
+  // At this point, user is authenticated. The dictionary itself is shared;
+  // the user's edits and statistics live in a per-user overlay.
+  LayeredDictionary tree(BaseDictionary::load("assets/dictionary.txt"));
   tree.loadStats(userPath + "stats.txt");
-  loadBookmarks(userPath + "bookmarks.txt");
-
-  // Initial global load
-  tree.loadWords("assets/dictionary.txt");
+  bookmarks.open(userPath + "bookmarks.txt");
 
   // Initialize cURL
   curl_global_init(CURL_GLOBAL_DEFAULT);
+  fetcher = std::make_unique<DefinitionFetcher>();
+  resolver = std::make_unique<DefinitionResolver>(*db, *fetcher);
+  prefetcher = std::make_unique<DefinitionPrefetcher>(*db, *resolver);
+  queryLog = QueryLog::from_env();
+
+  // Bookmarked words are likely lookups; fill in any missing meanings
+  std::vector<std::string> bookmarked;
+  for (const auto &[word, note] : bookmarks.list("", 0, bookmarks.size()))
+    bookmarked.push_back(word);
+  prefetcher->prefetch(bookmarked);
 
   // Word of the day
   static const std::string wodFile = userPath + "word_of_day.txt";
@@ -429,21 +713,18 @@ int main() {
     out << randomWord << " " << time(0);
     return randomWord;
   }();
-  
-  // Clean up cURL
-  curl_global_cleanup();
 
   if (!wod.empty()) {
     std::cout << BOLD_YELLOW << "\nWord of the Day: " << RESET << wod
               << std::endl;
-    getMeaningFromPython(wod);
+    getMeaning(wod);
   }
 
   int choice;
   std::string input;
   while (true) {
     showMenu();
-    std::cout << "Enter your choice (1-11): ";
+    std::cout << "Enter your choice (1-15): ";
     
     // Clear any error flags and ignore any leftover characters
     std::cin.clear();
@@ -459,7 +740,7 @@ int main() {
     try {
       choice = std::stoi(input);
     } catch (const std::exception&) {
-      std::cout << RED << "Please enter a valid number (1-11)." << RESET << std::endl;
+      std::cout << RED << "Please enter a valid number (1-15)." << RESET << std::endl;
       continue;
     }
 
@@ -469,7 +750,7 @@ int main() {
       std::cout << CYAN << "Enter word to insert: " << RESET;
       std::getline(std::cin, word);
       word = cleanInput(word);
-      tree.insert(word);
+      logged(QueryOp::Insert, word, [&] { tree.insert(word); });
       std::cout << GREEN << "'" << word << "' inserted." << RESET << std::endl;
       break;
     }
@@ -478,14 +759,20 @@ int main() {
       std::cout << CYAN << "Enter word to search: " << RESET;
       std::getline(std::cin, word);
       word = cleanInput(word);
-      if (tree.search(word)) {
+      bool found = logged(QueryOp::Search, word, [&] {
+        bool hit = tree.search(word);
+        if (hit)
+          tree.recordUsage(word);
+        return hit;
+      });
+      if (found) {
         std::cout << GREEN << "'" << word << "' found! Fetching meaning..."
                   << RESET << std::endl;
-        tree.recordUsage(word);
-        getMeaningFromPython(word);
+        getMeaning(word);
       } else {
         std::cout << RED << "'" << word << "' not found." << RESET << std::endl;
-        auto sug = tree.suggest(word);
+        auto sug = logged(QueryOp::Suggest, word,
+                          [&] { return tree.suggest(word); });
         if (!sug.empty()) {
           std::cout << YELLOW << "Did you mean:" << RESET;
           for (auto &s : sug)
@@ -500,7 +787,7 @@ int main() {
       std::cout << CYAN << "Enter word to remove: " << RESET;
       std::getline(std::cin, word);
       word = cleanInput(word);
-      tree.remove(word);
+      logged(QueryOp::Remove, word, [&] { tree.remove(word); });
       std::cout << GREEN << "'" << word << "' removed." << RESET << std::endl;
       break;
     }
@@ -509,7 +796,8 @@ int main() {
       std::cout << CYAN << "Enter prefix: " << RESET;
       std::getline(std::cin, prefix);
       prefix = cleanInput(prefix);
-      auto words = tree.starts_with(prefix);
+      auto words = logged(QueryOp::Prefix, prefix,
+                          [&] { return tree.starts_with(prefix); });
       if (words.empty())
         std::cout << RED << "No matches." << RESET << std::endl;
       else {
@@ -517,11 +805,12 @@ int main() {
         for (auto &w : words) {
           std::cout << "- " << w << std::endl;
         }
+        prefetchCompletions(tree, words);
       }
       break;
     }
     case 5: {
-      auto top = tree.getTopNWords(5);
+      auto top = logged(QueryOp::Top, "5", [&] { return tree.getTopNWords(5); });
       std::cout << BOLD_YELLOW << "\nTop 5 Searched Words:" << RESET
                 << std::endl;
       for (auto &[w, f] : top) {
@@ -546,24 +835,33 @@ int main() {
     }
     case 9: {
       removeBookmark();
-      std::string word;
-      std::cout << CYAN << "Enter word to remove bookmark: " << RESET;
-      std::getline(std::cin, word);
-      if (bookmarks.erase(word))
-        std::cout << GREEN << "Removed bookmark for '" << word << "'." << RESET
-                  << std::endl;
-      else
-        std::cout << RED << "No bookmark for '" << word << "'." << RESET
-                  << std::endl;
       break;
     }
     case 10:
-      exportStatsToCSV(tree, userPath + "export.csv");
+      exportStats(tree, userPath);
       break;
     case 11:
+      showCompactReport(tree, userPath);
+      break;
+    case 12:
+      importDefinitions();
+      break;
+    case 13:
+      searchDefinitions();
+      break;
+    case 14:
+      showMetrics();
+      break;
+    case 15:
       std::cout << BOLD_BLUE << "Exiting. Goodbye!" << RESET << std::endl;
       tree.saveStats(userPath + "stats.txt");
-      saveBookmarks(userPath + "bookmarks.txt");
+      bookmarks.close();
+      queryLog.reset();
+      // Clean up cURL
+      prefetcher.reset();
+      resolver.reset();
+      fetcher.reset();
+      curl_global_cleanup();
       return 0;
     default:
       std::cout << RED << "Invalid choice." << RESET << std::endl;
@@ -0,0 +1,382 @@
+#include "../include/metrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+#ifdef DICT_ENABLE_METRICS
+
+namespace {
+
+const char* const TIMER_NAMES[] = {
+    "tree.insert",
+    "tree.search",
+    "tree.remove",
+    "tree.starts_with",
+    "tree.suggest",
+    "tree.top_n",
+    "tree.load_words",
+    "tree.load_stats",
+    "tree.save_stats",
+    "db.add_word",
+    "db.add_words",
+    "db.get_meaning",
+    "db.mark_missing",
+    "db.known_missing",
+    "db.word_exists",
+    "db.record_search",
+    "db.search_history",
+    "db.flush",
+    "db.daily_counts",
+    "db.search_definitions",
+    "db.write_batch",
+    "net.fetch",
+};
+
+const char* const COUNTER_NAMES[] = {
+    "cache.hit",
+    "cache.negative_hit",
+    "cache.miss",
+    "net.fetch_ok",
+    "net.fetch_not_found",
+    "net.fetch_error",
+};
+
+constexpr size_t TIMERS = static_cast<size_t>(Timer::Count);
+constexpr size_t COUNTERS = static_cast<size_t>(Counter::Count);
+static_assert(sizeof(TIMER_NAMES) / sizeof(TIMER_NAMES[0]) == TIMERS, "one name per timer");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == COUNTERS, "one name per counter");
+
+// Values below 2^SUB_BITS get a bucket each; above that every power of two
+// is split into 2^SUB_BITS equal buckets. Anything past 2^(MAX_BIT+1)
+// ticks (several minutes) lands in the last bucket.
+constexpr int SUB_BITS = 4;
+constexpr uint64_t SUB = 1u << SUB_BITS;
+constexpr int MAX_BIT = 39;
+constexpr size_t BUCKETS = (MAX_BIT - SUB_BITS + 2) * SUB;
+constexpr uint64_t MAX_VALUE = (uint64_t(1) << (MAX_BIT + 1)) - 1;
+
+size_t bucket_of(uint64_t v) {
+    if (v < SUB) {
+        return v;
+    }
+    v = std::min(v, MAX_VALUE);
+    int bit = 63 - __builtin_clzll(v);
+    int shift = bit - SUB_BITS;
+    return (shift + 1) * SUB + ((v >> shift) & (SUB - 1));
+}
+
+// Largest value that falls into bucket `i`
+uint64_t bucket_top(size_t i) {
+    if (i < SUB) {
+        return i;
+    }
+    int shift = static_cast<int>(i / SUB) - 1;
+    uint64_t low = (SUB + i % SUB) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+}
+
+// Written only by the owning thread, read by whoever merges
+struct Histogram {
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+struct Block {
+    Histogram timers[TIMERS];
+    std::atomic<uint64_t> counters[COUNTERS] = {};
+};
+
+// Single-writer increment: no locked read-modify-write needed
+inline void bump(std::atomic<uint64_t>& a, uint64_t n) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct Totals {
+    struct Hist {
+        uint64_t buckets[BUCKETS] = {};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+    };
+    Hist timers[TIMERS];
+    uint64_t counters[COUNTERS] = {};
+
+    void add(const Block& block) {
+        for (size_t t = 0; t < TIMERS; ++t) {
+            const Histogram& from = block.timers[t];
+            Hist& to = timers[t];
+            uint64_t n = from.count.load(std::memory_order_relaxed);
+            if (n == 0) {
+                continue;
+            }
+            to.count += n;
+            to.sum += from.sum.load(std::memory_order_relaxed);
+            to.max = std::max(to.max, from.max.load(std::memory_order_relaxed));
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t c = 0; c < COUNTERS; ++c) {
+            counters[c] += block.counters[c].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<Block*> live;
+    std::unique_ptr<Totals> retired = std::make_unique<Totals>();
+};
+
+// Never destroyed: threads owned by static objects (the app's database
+// writer, for one) can still record while statics are being torn down
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+// The calling thread's block; trivially destructible so it stays usable
+// however late in the thread's life something is timed
+thread_local Block* current = nullptr;
+
+// Folds the thread's block into the retired totals when the thread exits
+struct Retire {
+    ~Retire() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.retired->add(*current);
+        r.live.erase(std::find(r.live.begin(), r.live.end(), current));
+        delete current;
+        current = nullptr;
+    }
+};
+
+Block& local() {
+    if (!current) {
+        auto block = std::make_unique<Block>();
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.live.push_back(block.get());
+        }
+        current = block.release();
+        // Constructed once per thread; a block created after it has run
+        // (only possible during exit) simply stays registered
+        thread_local Retire retire;
+        (void)retire;
+    }
+    return *current;
+}
+
+std::unique_ptr<Totals> merged() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto totals = std::make_unique<Totals>(*r.retired);
+    for (const Block* block : r.live) {
+        totals->add(*block);
+    }
+    return totals;
+}
+
+// The TSC runs at a constant rate on anything recent, so it is timed
+// against steady_clock once, over a short spin
+double nanos_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const double ratio = [] {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t first = ticks();
+        auto now = start;
+        while (now - start < std::chrono::milliseconds(20)) {
+            now = std::chrono::steady_clock::now();
+        }
+        uint64_t elapsed = ticks() - first;
+        double nanos = std::chrono::duration<double, std::nano>(now - start).count();
+        return elapsed > 0 ? nanos / elapsed : 1.0;
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+uint64_t percentile(const Totals::Hist& h, double p) {
+    // Nearest rank: the smallest value with at least p of the samples at
+    // or below it
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * h.count)));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        seen += h.buckets[b];
+        if (seen >= rank) {
+            return std::min(bucket_top(b), h.max);
+        }
+    }
+    return h.max;
+}
+
+std::string duration(uint64_t ticks) {
+    uint64_t nanos = static_cast<uint64_t>(ticks * nanos_per_tick());
+    char buf[32];
+    if (nanos < 1000) {
+        std::snprintf(buf, sizeof(buf), "%lluns", static_cast<unsigned long long>(nanos));
+    } else if (nanos < 1000000) {
+        std::snprintf(buf, sizeof(buf), "%.1fus", nanos / 1e3);
+    } else if (nanos < 1000000000) {
+        std::snprintf(buf, sizeof(buf), "%.1fms", nanos / 1e6);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.2fs", nanos / 1e9);
+    }
+    return buf;
+}
+
+} // namespace
+
+void record(Timer timer, uint64_t elapsed_ticks) {
+    Histogram& h = local().timers[static_cast<size_t>(timer)];
+    bump(h.buckets[bucket_of(elapsed_ticks)], 1);
+    bump(h.count, 1);
+    bump(h.sum, elapsed_ticks);
+    if (elapsed_ticks > h.max.load(std::memory_order_relaxed)) {
+        h.max.store(elapsed_ticks, std::memory_order_relaxed);
+    }
+}
+
+void count(Counter counter, uint64_t n) {
+    bump(local().counters[static_cast<size_t>(counter)], n);
+}
+
+std::string report() {
+    auto totals = merged();
+    std::ostringstream out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-22s %10s %9s %9s %9s %9s %9s\n",
+                  "operation", "count", "mean", "p50", "p90", "p99", "max");
+    out << line;
+    bool any = false;
+    for (size_t t = 0; t < TIMERS; ++t) {
+        const Totals::Hist& h = totals->timers[t];
+        if (h.count == 0) {
+            continue;
+        }
+        any = true;
+        std::snprintf(line, sizeof(line), "%-22s %10llu %9s %9s %9s %9s %9s\n",
+                      TIMER_NAMES[t], static_cast<unsigned long long>(h.count),
+                      duration(h.sum / h.count).c_str(), duration(percentile(h, 0.5)).c_str(),
+                      duration(percentile(h, 0.9)).c_str(), duration(percentile(h, 0.99)).c_str(),
+                      duration(h.max).c_str());
+        out << line;
+    }
+    if (!any) {
+        out << "(no operations recorded yet)\n";
+    }
+
+    out << "\n";
+    for (size_t c = 0; c < COUNTERS; ++c) {
+        std::snprintf(line, sizeof(line), "%-22s %10llu\n", COUNTER_NAMES[c],
+                      static_cast<unsigned long long>(totals->counters[c]));
+        out << line;
+    }
+    const uint64_t* n = totals->counters;
+    uint64_t hits = n[static_cast<size_t>(Counter::CacheHit)] + n[static_cast<size_t>(Counter::CacheNegativeHit)];
+    uint64_t lookups = hits + n[static_cast<size_t>(Counter::CacheMiss)];
+    if (lookups > 0) {
+        std::snprintf(line, sizeof(line), "%-22s %9.1f%%\n", "cache.hit_ratio", 100.0 * hits / lookups);
+        out << line;
+    }
+    return out.str();
+}
+
+struct PeriodicDump::State {
+    std::string path;
+    std::chrono::seconds interval;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread thread;
+
+    void write() {
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out) {
+                std::cerr << "Failed to write metrics to " << tmp << std::endl;
+                return;
+            }
+            out << report();
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to write metrics to " << path << std::endl;
+            std::remove(tmp.c_str());
+        }
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!cv.wait_for(lock, interval, [this] { return stopping; })) {
+            lock.unlock();
+            write();
+            lock.lock();
+        }
+    }
+};
+
+PeriodicDump::PeriodicDump(const std::string& path, unsigned interval_seconds)
+    : state(std::make_unique<State>()) {
+    state->path = path;
+    state->interval = std::chrono::seconds(std::max(1u, interval_seconds));
+    state->thread = std::thread(&State::loop, state.get());
+}
+
+PeriodicDump::~PeriodicDump() {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->stopping = true;
+    }
+    state->cv.notify_all();
+    state->thread.join();
+    state->write();
+}
+
+std::unique_ptr<PeriodicDump> PeriodicDump::from_env() {
+    const char* path = std::getenv("DICT_METRICS_DUMP");
+    if (!path || !*path) {
+        return nullptr;
+    }
+    unsigned interval = 60;
+    if (const char* env = std::getenv("DICT_METRICS_INTERVAL")) {
+        interval = static_cast<unsigned>(std::strtoul(env, nullptr, 10));
+    }
+    return std::make_unique<PeriodicDump>(path, interval);
+}
+
+#else
+
+std::string report() {
+    return "metrics are disabled in this build (rebuild with METRICS=1)\n";
+}
+
+struct PeriodicDump::State {};
+
+PeriodicDump::PeriodicDump(const std::string&, unsigned) {}
+
+PeriodicDump::~PeriodicDump() {}
+
+std::unique_ptr<PeriodicDump> PeriodicDump::from_env() {
+    return nullptr;
+}
+
+#endif
+
+} // namespace metrics
@@ -0,0 +1,129 @@
+#include "phonetic.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+bool oneOf(char c, const char *set) { return c && std::strchr(set, c); }
+
+bool vowel(char c) { return oneOf(c, "AEIOU"); }
+
+} // namespace
+
+std::string metaphone(const std::string &word) {
+  std::string w;
+  w.reserve(word.size());
+  for (unsigned char c : word)
+    if (c < 128 && std::isalpha(c))
+      w += (char)std::toupper(c);
+  std::string key;
+  if (w.empty())
+    return key;
+  key.reserve(w.size() + 1);
+  auto at = [&](size_t i) { return i < w.size() ? w[i] : '\0'; };
+
+  // Silent or merged first letters
+  size_t i = 0;
+  auto startsWith = [&](const char *pair) {
+    return w.compare(0, 2, pair) == 0;
+  };
+  if (startsWith("AE") || startsWith("GN") || startsWith("KN") ||
+      startsWith("PN") || startsWith("WR")) {
+    i = 1;
+  } else if (w[0] == 'X') {
+    key += 'S';
+    i = 1;
+  } else if (startsWith("WH")) {
+    key += 'W';
+    i = 2;
+  }
+  size_t first = i;
+
+  for (; i < w.size(); ++i) {
+    char c = w[i];
+    char prev = i > 0 ? w[i - 1] : '\0';
+    char next = at(i + 1), after = at(i + 2);
+    if (c == prev && c != 'C')
+      continue;
+    switch (c) {
+    case 'A':
+    case 'E':
+    case 'I':
+    case 'O':
+    case 'U':
+      if (i == first && key.empty())
+        key += 'A';
+      break;
+    case 'B': // silent in a final "mb"
+      if (!(prev == 'M' && i + 1 == w.size()))
+        key += 'B';
+      break;
+    case 'C':
+      if (next == 'I' && after == 'A')
+        key += 'X';
+      else if (next == 'H')
+        key += prev == 'S' ? 'K' : 'X';
+      else if (oneOf(next, "EIY"))
+        key += prev == 'S' ? "" : "S";
+      else
+        key += 'K';
+      break;
+    case 'D':
+      key += next == 'G' && oneOf(after, "EIY") ? 'J' : 'T';
+      break;
+    case 'G':
+      if (next == 'H' && i + 2 < w.size() && !vowel(after))
+        break; // "night"
+      if (next == 'N' && (i + 2 == w.size() ||
+                          (after == 'E' && at(i + 3) == 'D' &&
+                           i + 4 == w.size())))
+        break; // "sign", "signed"
+      if (prev == 'D' && oneOf(next, "EIY"))
+        break; // "edge", already J
+      key += oneOf(next, "EIY") ? 'J' : 'K';
+      break;
+    case 'H':
+      if (vowel(next) && !oneOf(prev, "CGPST"))
+        key += 'H';
+      break;
+    case 'K':
+      if (prev != 'C')
+        key += 'K';
+      break;
+    case 'P':
+      key += next == 'H' ? 'F' : 'P';
+      break;
+    case 'Q':
+      key += 'K';
+      break;
+    case 'S':
+      key += next == 'H' || (next == 'I' && oneOf(after, "AO")) ? 'X' : 'S';
+      break;
+    case 'T':
+      if (next == 'I' && oneOf(after, "AO"))
+        key += 'X';
+      else if (next == 'H')
+        key += '0';
+      else if (!(next == 'C' && after == 'H'))
+        key += 'T';
+      break;
+    case 'V':
+      key += 'F';
+      break;
+    case 'W':
+    case 'Y':
+      if (vowel(next))
+        key += c;
+      break;
+    case 'X':
+      key += "KS";
+      break;
+    case 'Z':
+      key += 'S';
+      break;
+    default: // F J L M N R
+      key += c;
+    }
+  }
+  return key;
+}
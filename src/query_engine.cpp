@@ -0,0 +1,132 @@
+#include "../include/query_engine.hpp"
+#include "../include/metrics.hpp"
+#include <algorithm>
+
+QueryEngine::QueryEngine(RadixTree& tree, DictionaryDB& db, DefinitionResolver& resolver)
+    : tree(tree), db(db), resolver(resolver), top_words(tree.getTopNWords(TOP_CACHE)) {}
+
+void QueryEngine::update_top(const std::string& word) {
+    int frequency = tree.getWordInfo(word).frequency;
+
+    auto it = std::find_if(top_words.begin(), top_words.end(),
+                           [&](const std::pair<std::string, int>& entry) { return entry.first == word; });
+    if (it == top_words.end()) {
+        if (top_words.size() < TOP_CACHE) {
+            top_words.emplace_back(word, frequency);
+        } else if (frequency > top_words.back().second) {
+            top_words.back() = {word, frequency};
+        } else {
+            return;
+        }
+        it = top_words.end() - 1;
+    } else {
+        it->second = frequency;
+    }
+    // Bubble the updated entry up to its place
+    while (it != top_words.begin() && (it - 1)->second < it->second) {
+        std::iter_swap(it - 1, it);
+        --it;
+    }
+}
+
+bool QueryEngine::search(const std::string& word) {
+    // The tree lock stays held while usage is recorded: a remove() slipping
+    // in between would see the word gone from top_words, and we would put it
+    // back
+    std::shared_lock<std::shared_mutex> lock(tree_mutex);
+    if (!tree.search(word)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> stats_lock(stats_mutex);
+    tree.recordUsage(word);
+    update_top(word);
+    return true;
+}
+
+std::vector<std::string> QueryEngine::prefix(const std::string& prefix, size_t limit) const {
+    std::vector<std::string> words;
+    {
+        std::shared_lock<std::shared_mutex> lock(tree_mutex);
+        words = tree.starts_with(prefix);
+    }
+    // The tree hands words back in hash order; only sort what is returned
+    if (words.size() > limit) {
+        std::nth_element(words.begin(), words.begin() + limit, words.end());
+        words.resize(limit);
+    }
+    std::sort(words.begin(), words.end());
+    return words;
+}
+
+std::vector<std::string> QueryEngine::suggest(const std::string& word, int max_distance) const {
+    METRIC_TIMER(TreeSuggest);
+    std::vector<std::string> words;
+    {
+        std::shared_lock<std::shared_mutex> lock(tree_mutex);
+        words = tree.candidates(word, max_distance);
+    }
+    // Ranking reads the word statistics, which search() updates under stats_mutex alone
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    tree.rankByFrequency(words);
+    return words;
+}
+
+std::vector<std::pair<std::string, int>> QueryEngine::top(int n) const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    if (n < 0 || static_cast<size_t>(n) > TOP_CACHE) {
+        return tree.getTopNWords(n);
+    }
+    return {top_words.begin(), top_words.begin() + std::min(top_words.size(), static_cast<size_t>(n))};
+}
+
+Resolution QueryEngine::meaning(const std::string& word) {
+    Resolution r = resolver.resolve(word);
+    if (r.found()) {
+        db.record_search(DefinitionResolver::normalize(word));
+    }
+    return r;
+}
+
+void QueryEngine::insert(const std::string& word) {
+    std::unique_lock<std::shared_mutex> lock(tree_mutex);
+    std::lock_guard<std::mutex> stats_lock(stats_mutex);  // insert records usage
+    tree.insert(word);
+    update_top(word);
+}
+
+bool QueryEngine::remove(const std::string& word) {
+    std::unique_lock<std::shared_mutex> lock(tree_mutex);
+    if (!tree.search(word)) {
+        return false;
+    }
+    tree.remove(word);
+
+    // A removed word must not linger in `top`
+    std::lock_guard<std::mutex> stats_lock(stats_mutex);
+    auto it = std::find_if(top_words.begin(), top_words.end(),
+                           [&](const std::pair<std::string, int>& entry) { return entry.first == word; });
+    if (it != top_words.end()) {
+        top_words.erase(it);
+        refill_top();
+    }
+    return true;
+}
+
+void QueryEngine::refill_top() {
+    if (top_words.size() >= TOP_CACHE) {
+        return;
+    }
+    // Removed words keep their statistics, so ask for enough to skip them
+    for (int n = TOP_CACHE;; n *= 2) {
+        std::vector<std::pair<std::string, int>> ranked = tree.getTopNWords(n);
+        top_words.clear();
+        for (auto& entry : ranked) {
+            if (top_words.size() < TOP_CACHE && tree.search(entry.first)) {
+                top_words.push_back(std::move(entry));
+            }
+        }
+        if (top_words.size() >= TOP_CACHE || ranked.size() < static_cast<size_t>(n)) {
+            return;
+        }
+    }
+}
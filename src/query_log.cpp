@@ -0,0 +1,277 @@
+#include "../include/query_log.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[] = "RDXQLOG1";
+const size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+const uint8_t SESSION = 0;
+const size_t FLUSH_BYTES = 64 * 1024;
+const auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool get_varint(const std::string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+// Bytes of `data` up to the end of its last complete record: 0 if not even
+// the magic is complete, std::string::npos if it is not a query log
+size_t complete_length(const std::string& data) {
+    if (data.size() < MAGIC_SIZE) {
+        return data.compare(0, data.size(), MAGIC, data.size()) == 0 ? 0 : std::string::npos;
+    }
+    if (data.compare(0, MAGIC_SIZE, MAGIC) != 0) {
+        return std::string::npos;
+    }
+    size_t pos = MAGIC_SIZE;
+    while (pos < data.size()) {
+        if (static_cast<uint8_t>(data[pos]) == SESSION) {
+            if (pos + 9 > data.size()) {
+                break;
+            }
+            pos += 9;
+            continue;
+        }
+        size_t p = pos + 1;
+        uint64_t delta, latency, length;
+        if (!get_varint(data, p, delta) || !get_varint(data, p, latency) ||
+            !get_varint(data, p, length) || length > data.size() - p) {
+            break;
+        }
+        pos = p + length;
+    }
+    return pos;
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+uint64_t wall_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const char* query_op_name(QueryOp op) {
+    switch (op) {
+    case QueryOp::Insert: return "insert";
+    case QueryOp::Remove: return "remove";
+    case QueryOp::Search: return "search";
+    case QueryOp::Suggest: return "suggest";
+    case QueryOp::Prefix: return "prefix";
+    case QueryOp::Complete: return "complete";
+    case QueryOp::Top: return "top";
+    case QueryOp::Meaning: return "meaning";
+    case QueryOp::Preview: return "preview";
+    case QueryOp::AddWord: return "add_word";
+    case QueryOp::SearchDefinitions: return "search_defs";
+    }
+    return "unknown";
+}
+
+QueryLog::QueryLog(const std::string& path) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open query log " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    // A crash can leave the last record half written, and the reader stops
+    // at the first record it cannot parse, so anything appended after it
+    // would be lost: cut the log back to its last complete record
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t keep = complete_length(data);
+    if (keep == std::string::npos) {
+        std::cerr << path << " is not a query log; not appending to it" << std::endl;
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    if (keep < data.size() && ftruncate(fd, static_cast<off_t>(keep)) != 0) {
+        std::cerr << "Failed to truncate query log " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        fd = -1;
+        return;
+    }
+    if (keep == 0) {
+        buffer.append(MAGIC, MAGIC_SIZE);
+    }
+    last_timestamp_us = wall_clock_us();
+    buffer += static_cast<char>(SESSION);
+    for (int i = 0; i < 8; ++i) {
+        buffer += static_cast<char>((last_timestamp_us >> (8 * i)) & 0xff);
+    }
+    write_buffer();
+    flusher = std::thread(&QueryLog::flush_loop, this);
+}
+
+QueryLog::~QueryLog() {
+    if (fd >= 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        flusher_cv.notify_one();
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        flush();
+        ::close(fd);
+    }
+}
+
+// Writes out whatever was appended in the last interval, so records reach
+// the file while the process sits idle rather than on the next append
+void QueryLog::flush_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        flusher_cv.wait_for(lock, FLUSH_INTERVAL, [this] { return stopping; });
+        if (!buffer.empty()) {
+            write_buffer();
+        }
+    }
+}
+
+void QueryLog::write_buffer() {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Failed to write query log: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        written += n;
+    }
+    buffer.clear();
+}
+
+void QueryLog::append(QueryOp op, const std::string& key, uint64_t timestamp_us, uint64_t latency_us) {
+    if (fd < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer += static_cast<char>(op);
+    put_varint(buffer, zigzag(static_cast<int64_t>(timestamp_us - last_timestamp_us)));
+    put_varint(buffer, latency_us);
+    put_varint(buffer, key.size());
+    buffer += key;
+    last_timestamp_us = timestamp_us;
+    if (buffer.size() >= FLUSH_BYTES) {
+        write_buffer();
+    }
+}
+
+void QueryLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0 && !buffer.empty()) {
+        write_buffer();
+    }
+}
+
+std::unique_ptr<QueryLog> QueryLog::from_env() {
+    const char* path = std::getenv("DICT_QUERY_LOG");
+    if (!path || !*path) {
+        return nullptr;
+    }
+    auto log = std::make_unique<QueryLog>(path);
+    if (!log->is_open()) {
+        return nullptr;
+    }
+    return log;
+}
+
+QueryLog::Scope::Scope(QueryLog* log, QueryOp op, const std::string& key) : log(log), op(op) {
+    if (log) {
+        this->key = key;
+        timestamp_us = wall_clock_us();
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+QueryLog::Scope::~Scope() {
+    if (log) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        log->append(op, key, timestamp_us,
+                    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+}
+
+bool QueryLogReader::open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (data.compare(0, MAGIC_SIZE, MAGIC) != 0) {
+        std::cerr << path << " is not a query log" << std::endl;
+        return false;
+    }
+    pos = MAGIC_SIZE;
+    valid = true;
+    return true;
+}
+
+bool QueryLogReader::next(QueryRecord& record) {
+    while (valid && pos < data.size()) {
+        uint8_t op = static_cast<uint8_t>(data[pos]);
+        if (op == SESSION) {
+            if (pos + 9 > data.size()) {
+                break;
+            }
+            uint64_t start = 0;
+            for (int i = 0; i < 8; ++i) {
+                start |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos + 1 + i])) << (8 * i);
+            }
+            last_timestamp_us = start;
+            pos += 9;
+            continue;
+        }
+        size_t p = pos + 1;
+        uint64_t delta, latency, length;
+        if (!get_varint(data, p, delta) || !get_varint(data, p, latency) ||
+            !get_varint(data, p, length) || length > data.size() - p) {
+            break;
+        }
+        record.op = static_cast<QueryOp>(op);
+        record.timestamp_us = last_timestamp_us + unzigzag(delta);
+        record.latency_us = latency;
+        record.key.assign(data, p, length);
+        last_timestamp_us = record.timestamp_us;
+        pos = p + length;
+        return true;
+    }
+    valid = false;
+    return false;
+}
@@ -0,0 +1,116 @@
+// radix_dictd: serves the dictionary over TCP and/or a Unix socket.
+// See dict_server.hpp for the protocol.
+#include "../include/database.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include "../include/dict_server.hpp"
+#include "../include/metrics.hpp"
+#include "../include/query_engine.hpp"
+#include "../include/radix_tree.hpp"
+#include <curl/curl.h>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+DictServer* running_server = nullptr;
+
+void handle_signal(int) {
+    if (running_server) {
+        running_server->stop();
+    }
+}
+
+void usage() {
+    std::cerr << "Usage: radix_dictd [--port N] [--bind ADDR] [--unix PATH] [--threads N]\n"
+                 "                   [--words FILE] [--db NAME] [--stats FILE]\n"
+                 "  --port 0 disables TCP. Word statistics are loaded from and saved\n"
+                 "  to --stats when given.\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    DictServerOptions options;
+    std::string words_file = "assets/dictionary.txt";
+    std::string db_name = "dictionary.db";
+    std::string stats_file;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--port" && has_value) {
+            options.port = std::stoi(argv[++i]);
+        } else if (arg == "--bind" && has_value) {
+            options.bind_address = argv[++i];
+        } else if (arg == "--unix" && has_value) {
+            options.unix_path = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            options.workers = std::stoul(argv[++i]);
+        } else if (arg == "--words" && has_value) {
+            words_file = argv[++i];
+        } else if (arg == "--db" && has_value) {
+            db_name = argv[++i];
+        } else if (arg == "--stats" && has_value) {
+            stats_file = argv[++i];
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.workers == 0) {
+        options.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    {
+        // DICT_METRICS_DUMP names a file to keep the latency report in
+        auto metrics_dump = metrics::PeriodicDump::from_env();
+
+        // Workers read definitions concurrently, one pooled connection each
+        DictionaryDBOptions db_options;
+        db_options.read_connections = options.workers;
+        DictionaryDB db(db_name, db_options);
+        DefinitionFetcher fetcher;
+        DefinitionResolver resolver(db, fetcher);
+
+        RadixTree tree;
+        tree.loadWords(words_file);
+        if (!stats_file.empty()) {
+            tree.loadStats(stats_file);
+        }
+        QueryEngine engine(tree, db, resolver);
+
+        DictServer server(engine, options);
+        if (!server.start()) {
+            return 1;
+        }
+        running_server = &server;
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        std::cerr << "radix_dictd: " << options.workers << " workers";
+        if (options.port > 0) {
+            std::cerr << ", " << options.bind_address << ":" << options.port;
+        }
+        if (!options.unix_path.empty()) {
+            std::cerr << ", " << options.unix_path;
+        }
+        std::cerr << std::endl;
+
+        server.run();
+        running_server = nullptr;
+        std::cerr << "radix_dictd: shutting down" << std::endl;
+
+        db.flush();
+        if (!stats_file.empty()) {
+            tree.saveStats(stats_file);
+        }
+    }
+    curl_global_cleanup();
+    return 0;
+}
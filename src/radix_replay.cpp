@@ -0,0 +1,327 @@
+// radix_replay: re-drives a query log captured with DICT_QUERY_LOG (see
+// query_log.hpp) against a fresh RadixTree and DictionaryDB, with online
+// lookups answered by a stub, and reports throughput and latency per
+// operation so captured traces can serve as regression benchmarks.
+#include "../include/database.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include "../include/metrics.hpp"
+#include "../include/query_log.hpp"
+#include "../include/radix_tree.hpp"
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void usage() {
+    std::cerr << "Usage: radix_replay LOG [--speed X] [--words FILE] [--stats FILE] [--db PATH]\n"
+                 "                    [--fetch-ms N] [--out FILE] [--metrics]\n"
+                 "  --speed 0 (the default) replays as fast as possible; X > 0 keeps\n"
+                 "  the recorded gaps between operations, divided by X. Without --db\n"
+                 "  a fresh database is created in the temporary directory and\n"
+                 "  removed afterwards. Online lookups take --fetch-ms (default 0).\n";
+}
+
+// Answers every lookup with a made-up definition after a fixed delay, so a
+// replay neither depends on nor hammers the real API
+class StubFetcher : public DefinitionFetcher {
+private:
+    std::chrono::milliseconds delay;
+
+public:
+    explicit StubFetcher(std::chrono::milliseconds delay) : DefinitionFetcher("http://127.0.0.1/"), delay(delay) {}
+
+    FetchResult fetch(const std::string& word) override {
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+        FetchResult result;
+        result.status = FetchResult::Status::Ok;
+        result.http_status = 200;
+        result.senses.push_back({"noun", "Replayed definition of " + word + ".", ""});
+        return result;
+    }
+};
+
+// Does what radix_dict or dict_app did for each logged operation, minus the
+// printing
+class Replayer {
+private:
+    RadixTree& tree;
+    DictionaryDB& db;
+    DefinitionResolver& resolver;
+    RadixTree::Cursor completion;  // followed keystroke by keystroke, as in dict_app
+
+    static constexpr size_t COMPLETIONS = 8;  // UI::MAX_COMPLETIONS
+
+    void complete(const std::string& input) {
+        const std::string& prefix = completion.prefix();
+        if (input.size() == prefix.size() + 1 && input.compare(0, prefix.size(), prefix) == 0) {
+            completion.push(input.back());
+        } else if (input.size() + 1 == prefix.size() && prefix.compare(0, input.size(), input) == 0) {
+            completion.pop();
+        } else if (input != prefix) {
+            completion = tree.cursor();
+            for (char c : input) {
+                completion.push(c);
+            }
+        }
+        completion.complete(COMPLETIONS);
+    }
+
+public:
+    Replayer(RadixTree& tree, DictionaryDB& db, DefinitionResolver& resolver)
+        : tree(tree), db(db), resolver(resolver), completion(tree.cursor()) {}
+
+    // False for an operation this build does not know
+    bool run(const QueryRecord& record) {
+        const std::string& key = record.key;
+        switch (record.op) {
+        case QueryOp::Insert:
+            tree.insert(key);
+            completion = tree.cursor();
+            return true;
+        case QueryOp::Remove:
+            tree.remove(key);
+            completion = tree.cursor();
+            return true;
+        case QueryOp::Search:
+            if (tree.search(key)) {
+                tree.recordUsage(key);
+            }
+            return true;
+        case QueryOp::Suggest:
+            tree.suggest(key);
+            return true;
+        case QueryOp::Prefix:
+            tree.starts_with(key);
+            return true;
+        case QueryOp::Complete:
+            complete(key);
+            return true;
+        case QueryOp::Top:
+            tree.getTopNWords(std::max(1, std::atoi(key.c_str())));
+            return true;
+        case QueryOp::Meaning:
+            if (resolver.resolve(key).found()) {
+                db.record_search(DefinitionResolver::normalize(key));
+            }
+            return true;
+        case QueryOp::Preview:
+            resolver.resolve(key);
+            return true;
+        case QueryOp::AddWord:
+            if (!tree.search(key)) {
+                tree.insert(key);
+                completion = tree.cursor();
+                db.add_word(key, "Replayed meaning of " + key + ".");
+            }
+            return true;
+        case QueryOp::SearchDefinitions:
+            db.search_definitions(key, 20);
+            return true;
+        }
+        return false;
+    }
+};
+
+struct OpStats {
+    std::vector<float> replayed_us;
+    std::vector<float> recorded_us;
+    double total_us = 0;
+};
+
+double percentile(const std::vector<float>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+void remove_database(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+        return argc >= 2 && std::string(argv[1]) == "--help" ? 0 : 1;
+    }
+    std::string log_path = argv[1];
+    std::string words_file = "assets/dictionary.txt";
+    std::string stats_file;
+    std::string db_path;
+    std::string out_path;
+    double speed = 0;
+    long fetch_ms = 0;
+    bool show_metrics = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--speed" && has_value) {
+            speed = std::atof(argv[++i]);
+        } else if (arg == "--words" && has_value) {
+            words_file = argv[++i];
+        } else if (arg == "--stats" && has_value) {
+            stats_file = argv[++i];
+        } else if (arg == "--db" && has_value) {
+            db_path = argv[++i];
+        } else if (arg == "--fetch-ms" && has_value) {
+            fetch_ms = std::atol(argv[++i]);
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--metrics") {
+            show_metrics = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    QueryLogReader reader;
+    if (!reader.open(log_path)) {
+        return 1;
+    }
+    std::vector<QueryRecord> records;
+    QueryRecord record;
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+    if (records.empty()) {
+        std::cerr << log_path << " holds no operations" << std::endl;
+        return 1;
+    }
+
+    bool temporary_db = db_path.empty();
+    if (temporary_db) {
+        db_path = (std::filesystem::temp_directory_path() /
+                   ("radix_replay-" + std::to_string(getpid()) + ".db")).string();
+        remove_database(db_path);
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    std::vector<OpStats> stats(256);
+    uint64_t unknown = 0;
+    std::vector<float> lag_us;  // how late each paced operation started
+    double seconds = 0;
+    double flush_ms = 0;
+    {
+        DictionaryDB db(db_path);
+        StubFetcher fetcher{std::chrono::milliseconds(fetch_ms)};
+        DefinitionResolver resolver(db, fetcher);
+
+        RadixTree tree;
+        tree.loadWords(words_file);
+        if (!stats_file.empty()) {
+            tree.loadStats(stats_file);
+        }
+        Replayer replayer(tree, db, resolver);
+
+        uint64_t first_us = records.front().timestamp_us;
+        auto start = Clock::now();
+        for (const QueryRecord& r : records) {
+            if (speed > 0) {
+                // Timestamps may step back a little where two threads logged
+                double offset_us = r.timestamp_us > first_us ? (r.timestamp_us - first_us) / speed : 0;
+                auto due = start + std::chrono::microseconds(static_cast<int64_t>(offset_us));
+                if (Clock::now() < due) {
+                    std::this_thread::sleep_until(due);
+                }
+                lag_us.push_back(std::chrono::duration<float, std::micro>(Clock::now() - due).count());
+            }
+            auto began = Clock::now();
+            if (!replayer.run(r)) {
+                ++unknown;
+                continue;
+            }
+            float us = std::chrono::duration<float, std::micro>(Clock::now() - began).count();
+            OpStats& s = stats[static_cast<uint8_t>(r.op)];
+            s.replayed_us.push_back(us);
+            s.recorded_us.push_back(static_cast<float>(r.latency_us));
+            s.total_us += us;
+        }
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        auto flush_start = Clock::now();
+        db.flush();
+        flush_ms = std::chrono::duration<double, std::milli>(Clock::now() - flush_start).count();
+    }
+    curl_global_cleanup();
+    if (temporary_db) {
+        remove_database(db_path);
+    }
+
+    std::ostringstream out;
+    char line[200];
+    uint64_t replayed = records.size() - unknown;
+    std::snprintf(line, sizeof(line), "# radix_replay %s: %llu operations in %.3fs (%.0f ops/s), %s",
+                  log_path.c_str(), static_cast<unsigned long long>(replayed), seconds,
+                  seconds > 0 ? replayed / seconds : 0.0,
+                  speed > 0 ? "paced" : "as fast as possible");
+    out << line;
+    if (speed > 0) {
+        std::snprintf(line, sizeof(line), " at %gx", speed);
+        out << line;
+    }
+    out << "\n# stub fetch " << fetch_ms << " ms; final database flush " << std::fixed;
+    out.precision(1);
+    out << flush_ms << " ms\n";
+    if (unknown > 0) {
+        out << "# skipped " << unknown << " operations of unknown type\n";
+    }
+    if (!lag_us.empty()) {
+        std::sort(lag_us.begin(), lag_us.end());
+        std::snprintf(line, sizeof(line), "# start lag us: p50 %.1f p99 %.1f max %.1f\n",
+                      percentile(lag_us, 0.50), percentile(lag_us, 0.99), lag_us.back());
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "# %-12s %8s %11s %9s %9s %9s %10s %12s %12s\n",
+                  "op", "count", "ops/s", "p50_us", "p90_us", "p99_us", "max_us", "rec_p50_us", "rec_p99_us");
+    out << line;
+    for (size_t op = 0; op < stats.size(); ++op) {
+        OpStats& s = stats[op];
+        if (s.replayed_us.empty()) {
+            continue;
+        }
+        std::sort(s.replayed_us.begin(), s.replayed_us.end());
+        std::sort(s.recorded_us.begin(), s.recorded_us.end());
+        double ops = s.total_us > 0 ? s.replayed_us.size() / (s.total_us / 1e6) : 0;
+        std::snprintf(line, sizeof(line), "  %-12s %8zu %11.0f %9.1f %9.1f %9.1f %10.1f %12.0f %12.0f\n",
+                      query_op_name(static_cast<QueryOp>(op)), s.replayed_us.size(), ops,
+                      percentile(s.replayed_us, 0.50), percentile(s.replayed_us, 0.90),
+                      percentile(s.replayed_us, 0.99), s.replayed_us.back(),
+                      percentile(s.recorded_us, 0.50), percentile(s.recorded_us, 0.99));
+        out << line;
+    }
+    if (show_metrics) {
+        out << "\n" << metrics::report();
+    }
+
+    std::cout << out.str();
+    if (!out_path.empty()) {
+        std::ofstream file(out_path);
+        if (!(file << out.str())) {
+            std::cerr << "Failed to write " << out_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "radix_tree.hpp"
+#include "metrics.hpp"
+#include "phonetic.hpp"
 
 RadixTree::RadixTree() : root(std::make_shared<RadixTreeNode>()) {}
 
@@ -12,6 +14,7 @@ size_t RadixTree::commonPrefix(const std::string &s1,
 }
 
 void RadixTree::insert(const std::string &key) {
+  METRIC_TIMER(TreeInsert);
   auto node = root;
   std::string remaining = key;
 
@@ -30,6 +33,8 @@ void RadixTree::insert(const std::string &key) {
         auto split = std::make_shared<RadixTreeNode>();
         split->children[labelRemainder] = child;
         split->isEndOfWord = false;
+        split->parent = node.get();
+        child->parent = split.get();
         // replace original
         node->children.erase(label);
         node->children[label.substr(0, common)] = split;
@@ -43,17 +48,22 @@ void RadixTree::insert(const std::string &key) {
       // no match, create new child
       auto leaf = std::make_shared<RadixTreeNode>();
       leaf->isEndOfWord = true;
+      leaf->parent = node.get();
       node->children[remaining] = leaf;
+      indexPhonetic(key, leaf.get());
       recordUsage(key);
       return;
     }
   }
   // mark end of word
+  if (!node->isEndOfWord)
+    indexPhonetic(key, node.get());
   node->isEndOfWord = true;
   recordUsage(key);
 }
 
 bool RadixTree::search(const std::string &key) const {
+  METRIC_TIMER(TreeSearch);
   auto node = root;
   std::string remaining = key;
 
@@ -73,31 +83,83 @@ bool RadixTree::search(const std::string &key) const {
   return node->isEndOfWord;
 }
 
-void RadixTree::remove(const std::string &key) { removeHelper(root, key, 0); }
+void RadixTree::remove(const std::string &key) {
+  METRIC_TIMER(TreeRemove);
+  removeHelper(root, key, 0);
+}
 
+// True if the key was found and unmarked
 bool RadixTree::removeHelper(const std::shared_ptr<RadixTreeNode> &node,
                              const std::string &key, size_t depth) {
   if (depth == key.size()) {
     if (!node->isEndOfWord)
       return false;
     node->isEndOfWord = false;
-    // if leaf
-    return node->children.empty();
+    unindexPhonetic(key, node.get()); // before the node can be pruned
+    return true;
   }
   for (auto it = node->children.begin(); it != node->children.end(); ++it) {
     const std::string label = it->first;
-    if (key.rfind(label, depth) == depth) {
-      bool shouldDeleteChild =
-          removeHelper(it->second, key, depth + label.size());
-      if (shouldDeleteChild) {
-        node->children.erase(it);
-        return !node->isEndOfWord && node->children.size() == 1;
+    if (key.compare(depth, label.size(), label) != 0)
+      continue;
+    auto child = it->second;
+    if (!removeHelper(child, key, depth + label.size()))
+      return false;
+    // Prune an emptied leaf, and fold a node left with a single child into
+    // its edge so edges stay maximal (pruning it instead lost the sibling)
+    if (!child->isEndOfWord && child->children.size() <= 1) {
+      node->children.erase(it);
+      if (!child->children.empty()) {
+        auto &[rest, grandchild] = *child->children.begin();
+        grandchild->parent = node.get();
+        node->children[label + rest] = grandchild;
       }
     }
+    return true;
   }
   return false;
 }
 
+void RadixTree::indexPhonetic(const std::string &word, RadixTreeNode *node) {
+  std::string code = metaphone(word);
+  if (code.empty())
+    return;
+  RadixTreeNode *&head = phonetic[std::hash<std::string>{}(code)];
+  node->nextAlike = head;
+  head = node;
+}
+
+void RadixTree::unindexPhonetic(const std::string &word, RadixTreeNode *node) {
+  auto it = phonetic.find(std::hash<std::string>{}(metaphone(word)));
+  if (it == phonetic.end())
+    return;
+  RadixTreeNode **link = &it->second;
+  while (*link && *link != node)
+    link = &(*link)->nextAlike;
+  if (!*link)
+    return;
+  *link = node->nextAlike;
+  node->nextAlike = nullptr;
+  if (!it->second)
+    phonetic.erase(it);
+}
+
+// Walks up to the root collecting edge labels; a node does not know its
+// own label, so each step looks it up among its parent's children
+std::string RadixTree::spell(const RadixTreeNode *node) {
+  std::vector<const std::string *> labels;
+  for (; node->parent; node = node->parent)
+    for (auto &[label, child] : node->parent->children)
+      if (child.get() == node) {
+        labels.push_back(&label);
+        break;
+      }
+  std::string word;
+  for (auto it = labels.rbegin(); it != labels.rend(); ++it)
+    word += **it;
+  return word;
+}
+
 void RadixTree::update(const std::string &oldKey, const std::string &newKey) {
   remove(oldKey);
   insert(newKey);
@@ -115,8 +177,10 @@ void RadixTree::collect_words(const std::shared_ptr<RadixTreeNode> &node,
 
 std::vector<std::string>
 RadixTree::starts_with(const std::string &prefix) const {
+  METRIC_TIMER(TreeStartsWith);
   auto node = root;
   std::string remaining = prefix;
+  std::string path = prefix;
   std::vector<std::string> results;
 
   // traverse to prefix node
@@ -126,8 +190,12 @@ RadixTree::starts_with(const std::string &prefix) const {
       size_t common = commonPrefix(label, remaining);
       if (common == 0)
         continue;
-      if (common < remaining.size())
-        return results;
+      if (common < label.size()) {
+        if (common < remaining.size())
+          return results;
+        // prefix ends inside this edge
+        path += label.substr(common);
+      }
       node = child;
       remaining = remaining.substr(common);
       matched = true;
@@ -136,12 +204,20 @@ RadixTree::starts_with(const std::string &prefix) const {
     if (!matched)
       return results;
   }
-  collect_words(node, prefix, results);
+  collect_words(node, path, results);
   return results;
 }
 
 std::vector<std::string> RadixTree::suggest(const std::string &word,
                                             int max_distance) const {
+  METRIC_TIMER(TreeSuggest);
+  std::vector<std::string> res = candidates(word, max_distance);
+  rankByFrequency(res);
+  return res;
+}
+
+std::vector<std::string> RadixTree::candidates(const std::string &word,
+                                               int max_distance) const {
   // naive: collect all words and filter by edit distance
   std::vector<std::string> all;
   collect_words(root, "", all);
@@ -163,9 +239,33 @@ std::vector<std::string> RadixTree::suggest(const std::string &word,
   for (auto &w : all)
     if (editDist(w, word) <= max_distance)
       res.push_back(w);
+
+  // Words that sound alike, however many edits apart ("fonetik")
+  std::string code = metaphone(word);
+  auto it = code.empty() ? phonetic.end()
+                         : phonetic.find(std::hash<std::string>{}(code));
+  if (it != phonetic.end())
+    for (const RadixTreeNode *n = it->second; n; n = n->nextAlike) {
+      std::string alike = spell(n);
+      if (metaphone(alike) == code)
+        res.push_back(std::move(alike));
+    }
   return res;
 }
 
+// Most frequent first, then alphabetically; drops duplicates
+void RadixTree::rankByFrequency(std::vector<std::string> &words) const {
+  std::vector<std::pair<int, std::string>> ranked;
+  ranked.reserve(words.size());
+  for (auto &w : words)
+    ranked.emplace_back(-getWordInfo(w).frequency, std::move(w));
+  std::sort(ranked.begin(), ranked.end());
+  ranked.erase(std::unique(ranked.begin(), ranked.end()), ranked.end());
+  words.clear();
+  for (auto &[freq, w] : ranked)
+    words.push_back(std::move(w));
+}
+
 void RadixTree::recordUsage(const std::string &word) {
   auto &info = wordStats[word];
   info.frequency++;
@@ -173,6 +273,7 @@ void RadixTree::recordUsage(const std::string &word) {
 }
 
 void RadixTree::loadStats(const std::string &filename) {
+  METRIC_TIMER(TreeLoadStats);
   std::ifstream in(filename);
   if (!in)
     return;
@@ -189,6 +290,7 @@ void RadixTree::loadStats(const std::string &filename) {
 }
 
 void RadixTree::saveStats(const std::string &filename) const {
+  METRIC_TIMER(TreeSaveStats);
   std::ofstream out(filename);
   for (auto &p : wordStats) {
     out << p.first << " " << p.second.frequency << " "
@@ -197,6 +299,7 @@ void RadixTree::saveStats(const std::string &filename) const {
 }
 
 void RadixTree::loadWords(const std::string &filename) {
+  METRIC_TIMER(TreeLoadWords);
   std::ifstream in(filename);
   if (!in)
     return;
@@ -206,12 +309,258 @@ void RadixTree::loadWords(const std::string &filename) {
 }
 
 std::vector<std::pair<std::string, int>> RadixTree::getTopNWords(int N) const {
-  std::vector<std::pair<std::string, int>> vec;
+  METRIC_TIMER(TreeTopN);
+  // Rank pointers into the map and only order the first N; copying and
+  // fully sorting every entry dominated `top` on large dictionaries
+  std::vector<const std::pair<const std::string, WordInfo> *> ranked;
+  ranked.reserve(wordStats.size());
   for (auto &p : wordStats)
-    vec.emplace_back(p.first, p.second.frequency);
-  std::sort(vec.begin(), vec.end(),
-            [](auto &a, auto &b) { return a.second > b.second; });
-  if (vec.size() > (size_t)N)
-    vec.resize(N);
+    ranked.push_back(&p);
+  size_t n = std::min(ranked.size(), (size_t)std::max(N, 0));
+  std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(),
+                    [](auto *a, auto *b) {
+                      return a->second.frequency > b->second.frequency;
+                    });
+  std::vector<std::pair<std::string, int>> vec;
+  vec.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    vec.emplace_back(ranked[i]->first, ranked[i]->second.frequency);
   return vec;
 }
+
+WordInfo RadixTree::getWordInfo(const std::string &word) const {
+  auto it = wordStats.find(word);
+  return it == wordStats.end() ? WordInfo{} : it->second;
+}
+
+size_t RadixTree::memoryUsage() const {
+  // Rough model of libstdc++ layouts: make_shared control block + node,
+  // one bucket pointer per bucket and one heap node per map entry. Labels
+  // only cost extra once they outgrow the small-string buffer.
+  const size_t sso = 15; // libstdc++ small-string capacity
+  size_t bytes = 0;
+  std::vector<const RadixTreeNode *> stack{root.get()};
+  while (!stack.empty()) {
+    const RadixTreeNode *node = stack.back();
+    stack.pop_back();
+    bytes += sizeof(RadixTreeNode) + 2 * sizeof(long);
+    bytes += node->children.bucket_count() * sizeof(void *);
+    for (auto &[label, child] : node->children) {
+      bytes += sizeof(void *) + sizeof(size_t) +
+               sizeof(std::pair<const std::string,
+                                std::shared_ptr<RadixTreeNode>>);
+      if (label.size() > sso)
+        bytes += label.capacity() + 1;
+      stack.push_back(child.get());
+    }
+  }
+  bytes += wordStats.bucket_count() * sizeof(void *);
+  for (auto &p : wordStats) {
+    bytes += sizeof(void *) + sizeof(size_t) + sizeof(p);
+    if (p.first.size() > sso)
+      bytes += p.first.capacity() + 1;
+  }
+  return bytes;
+}
+
+RadixTree::Cursor::Cursor(const RadixTreeNode *root) {
+  states.push_back({root, nullptr, nullptr, 0});
+}
+
+bool RadixTree::Cursor::push(char c) {
+  State next = states.back();
+  text.push_back(c);
+  if (!next.node) {
+    states.push_back(next);
+    return false;
+  }
+  if (next.target) {
+    // Inside an edge: only its next character can follow
+    if ((*next.label)[next.offset] == c) {
+      if (++next.offset == next.label->size())
+        next = {next.target, nullptr, nullptr, 0};
+    } else {
+      next.node = nullptr;
+    }
+  } else {
+    bool matched = false;
+    for (auto &[label, child] : next.node->children) {
+      if (label[0] != c)
+        continue;
+      next = label.size() == 1 ? State{child.get(), nullptr, nullptr, 0}
+                               : State{next.node, child.get(), &label, 1};
+      matched = true;
+      break;
+    }
+    if (!matched)
+      next.node = nullptr;
+  }
+  states.push_back(next);
+  return next.node != nullptr;
+}
+
+void RadixTree::Cursor::pop() {
+  if (states.size() > 1) {
+    states.pop_back();
+    text.pop_back();
+  }
+}
+
+std::vector<std::string> RadixTree::Cursor::complete(size_t limit) const {
+  std::vector<std::string> words;
+  const State &s = states.back();
+  if (!s.node || limit == 0)
+    return words;
+  const RadixTreeNode *start = s.target ? s.target : s.node;
+  std::string path = text;
+  if (s.target)
+    path += s.label->substr(s.offset);
+
+  // Depth-first with each node's children visited in label order, so the
+  // walk can stop as soon as `limit` words are found
+  std::function<void(const RadixTreeNode *)> walk =
+      [&](const RadixTreeNode *node) {
+        if (node->isEndOfWord)
+          words.push_back(path);
+        std::vector<const std::pair<const std::string,
+                                    std::shared_ptr<RadixTreeNode>> *>
+            edges;
+        for (auto &edge : node->children)
+          edges.push_back(&edge);
+        std::sort(edges.begin(), edges.end(),
+                  [](auto *a, auto *b) { return a->first < b->first; });
+        for (auto *edge : edges) {
+          if (words.size() >= limit)
+            return;
+          path += edge->first;
+          walk(edge->second.get());
+          path.resize(path.size() - edge->first.size());
+        }
+      };
+  walk(start);
+  if (words.size() > limit)
+    words.resize(limit);
+  return words;
+}
+
+RadixTree::Iterator::Frame
+RadixTree::Iterator::frameFor(const RadixTreeNode *node) {
+  Frame frame{node, {}, -1};
+  frame.edges.reserve(node->children.size());
+  for (auto &edge : node->children)
+    frame.edges.push_back(&edge);
+  std::sort(frame.edges.begin(), frame.edges.end(),
+            [](const Edge *a, const Edge *b) { return a->first < b->first; });
+  return frame;
+}
+
+void RadixTree::Iterator::reset() {
+  stack.clear();
+  text.clear();
+  stack.push_back(frameFor(root));
+}
+
+// Enters the edge the top frame points at
+void RadixTree::Iterator::descend() {
+  const Edge *edge = stack.back().edges[stack.back().index];
+  text += edge->first;
+  stack.push_back(frameFor(edge->second.get()));
+}
+
+void RadixTree::Iterator::ascend() {
+  stack.pop_back();
+  if (!stack.empty()) {
+    const Frame &parent = stack.back();
+    text.resize(text.size() - parent.edges[parent.index]->first.size());
+  }
+}
+
+// Next node in depth-first pre-order (a node before its children, children
+// in label order), which is lexicographic order of the paths
+bool RadixTree::Iterator::advance() {
+  while (!stack.empty()) {
+    Frame &top = stack.back();
+    if (++top.index < (int)top.edges.size()) {
+      descend();
+      return true;
+    }
+    ascend();
+  }
+  text.clear();
+  return false;
+}
+
+// Previous node in the same order: the last node under the previous
+// sibling, or the parent when there is none
+bool RadixTree::Iterator::retreat() {
+  if (stack.size() <= 1) {
+    stack.clear();
+    text.clear();
+    return false;
+  }
+  ascend();
+  if (--stack.back().index < 0)
+    return true;
+  descend();
+  while (!stack.back().edges.empty()) {
+    stack.back().index = (int)stack.back().edges.size() - 1;
+    descend();
+  }
+  return true;
+}
+
+void RadixTree::Iterator::next() {
+  while (advance()) {
+    if (stack.back().node->isEndOfWord)
+      return;
+  }
+}
+
+void RadixTree::Iterator::prev() {
+  while (retreat()) {
+    if (stack.back().node->isEndOfWord)
+      return;
+  }
+}
+
+void RadixTree::Iterator::seek(const std::string &key) {
+  reset();
+  size_t depth = 0;
+  while (depth < key.size()) {
+    Frame &top = stack.back();
+    int found = -1;
+    bool inside = false;
+    for (size_t i = 0; i < top.edges.size(); ++i) {
+      const std::string &label = top.edges[i]->first;
+      int cmp = key.compare(depth, label.size(), label);
+      if (cmp <= 0) {
+        found = (int)i;
+        inside = cmp == 0; // the key continues below this edge
+        break;
+      }
+    }
+    if (found < 0) {
+      // Every word here sorts before the key; continue after the subtree
+      top.index = (int)top.edges.size() - 1;
+      next();
+      return;
+    }
+    top.index = found;
+    descend();
+    if (!inside)
+      break; // every word below sorts after the key
+    depth = text.size();
+  }
+  if (!stack.back().node->isEndOfWord)
+    next();
+}
+
+void RadixTree::Iterator::seekToLast() {
+  reset();
+  while (!stack.back().edges.empty()) {
+    stack.back().index = (int)stack.back().edges.size() - 1;
+    descend();
+  }
+  if (!stack.back().node->isEndOfWord)
+    prev();
+}
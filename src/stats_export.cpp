@@ -0,0 +1,306 @@
+#include "../include/stats_export.hpp"
+#include "../include/json.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+void append_int(std::string& out, long long value) {
+    char buf[24];
+    auto end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+    out.append(buf, end);
+}
+
+void append_digits(std::string& out, unsigned value, int width) {
+    char buf[8];
+    for (int i = width - 1; i >= 0; --i) {
+        buf[i] = '0' + value % 10;
+        value /= 10;
+    }
+    out.append(buf, width);
+}
+
+// UTC "YYYY-MM-DDTHH:MM:SSZ" without gmtime: days to civil date as in
+// Howard Hinnant's date algorithms
+void append_time(std::string& out, time_t t) {
+    long long secs = t;
+    long long days = secs / 86400;
+    long long rem = secs % 86400;
+    if (rem < 0) {
+        rem += 86400;
+        --days;
+    }
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long year = yoe + era * 400;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    if (month <= 2) {
+        ++year;
+    }
+    append_digits(out, static_cast<unsigned>(year), 4);
+    out += '-';
+    append_digits(out, month, 2);
+    out += '-';
+    append_digits(out, day, 2);
+    out += 'T';
+    append_digits(out, static_cast<unsigned>(rem / 3600), 2);
+    out += ':';
+    append_digits(out, static_cast<unsigned>(rem / 60 % 60), 2);
+    out += ':';
+    append_digits(out, static_cast<unsigned>(rem % 60), 2);
+    out += 'Z';
+}
+
+// RFC 4180: quote fields holding a separator, quote or line break
+void append_csv_field(std::string& out, const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+template <typename T> void append_raw(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+StatsExporter::StatsExporter(const ExportOptions& options) : options(options) {
+    if (this->options.threads == 0) {
+        this->options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->options.chunk_rows == 0) {
+        this->options.chunk_rows = 1;
+    }
+}
+
+void StatsExporter::format(Chunk& chunk) const {
+    if (lookup_info) {
+        for (Row& row : chunk.rows) {
+            row.info = dict->getWordInfo(row.word);
+        }
+    }
+    std::string& out = chunk.out;
+    switch (options.format) {
+    case ExportFormat::CSV:
+        out.reserve(chunk.rows.size() * 40);
+        for (const Row& row : chunk.rows) {
+            append_csv_field(out, row.word);
+            out += ',';
+            append_int(out, row.info.frequency);
+            out += ',';
+            if (row.info.lastAccessTime != 0) {
+                append_time(out, row.info.lastAccessTime);
+            }
+            out += '\n';
+        }
+        break;
+    case ExportFormat::JSONL:
+        out.reserve(chunk.rows.size() * 72);
+        for (const Row& row : chunk.rows) {
+            out += "{\"word\":";
+            json::append_quoted(out, row.word);
+            out += ",\"frequency\":";
+            append_int(out, row.info.frequency);
+            out += ",\"last_used\":";
+            if (row.info.lastAccessTime != 0) {
+                out += '"';
+                append_time(out, row.info.lastAccessTime);
+                out += '"';
+            } else {
+                out += "null";
+            }
+            out += "}\n";
+        }
+        break;
+    case ExportFormat::Columnar: {
+        size_t word_bytes = 0;
+        for (const Row& row : chunk.rows) {
+            word_bytes += row.word.size();
+        }
+        out.reserve(4 + chunk.rows.size() * 16 + word_bytes);
+        append_raw(out, static_cast<uint32_t>(chunk.rows.size()));
+        for (const Row& row : chunk.rows) {
+            append_raw(out, static_cast<uint32_t>(row.word.size()));
+        }
+        for (const Row& row : chunk.rows) {
+            out += row.word;
+        }
+        for (const Row& row : chunk.rows) {
+            append_raw(out, static_cast<int32_t>(row.info.frequency));
+        }
+        for (const Row& row : chunk.rows) {
+            append_raw(out, static_cast<int64_t>(row.info.lastAccessTime));
+        }
+        break;
+    }
+    }
+    chunk.rows = std::vector<Row>();  // release the words early
+}
+
+void StatsExporter::worker() {
+    while (true) {
+        std::shared_ptr<Chunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_cv.wait(lock, [&] { return stopping || !todo.empty(); });
+            if (todo.empty()) {
+                return;
+            }
+            chunk = std::move(todo.front());
+            todo.pop_front();
+        }
+        format(*chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunk->formatted = true;
+        }
+        done_cv.notify_all();
+    }
+}
+
+bool StatsExporter::write_all(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += n;
+    }
+    stats.bytes += data.size();
+    return true;
+}
+
+void StatsExporter::drain(bool all) {
+    // Keep a couple of chunks per worker in flight; beyond that the reader
+    // waits for the writer instead of buffering the whole dictionary
+    size_t window = options.threads * 2;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!inflight.empty() && (all || inflight.size() > window || inflight.front()->formatted)) {
+        done_cv.wait(lock, [&] { return inflight.front()->formatted; });
+        std::shared_ptr<Chunk> chunk = std::move(inflight.front());
+        inflight.pop_front();
+        lock.unlock();
+        if (!failed && !write_all(chunk->out)) {
+            failed = true;
+        }
+        lock.lock();
+    }
+}
+
+void StatsExporter::submit(std::vector<Row> rows) {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->rows = std::move(rows);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inflight.push_back(chunk);
+        todo.push_back(chunk);
+    }
+    work_cv.notify_one();
+    drain(false);
+}
+
+bool StatsExporter::run(const LayeredDictionary& dict, const std::string& path, ExportStats* result) {
+    auto start = std::chrono::steady_clock::now();
+    std::string tmp_path = path + ".tmp";
+    fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << tmp_path << " for writing" << std::endl;
+        return false;
+    }
+    this->dict = &dict;
+    lookup_info = options.order == ExportOrder::Lexicographic;
+    failed = false;
+    stopping = false;
+    stats = ExportStats();
+
+    if (options.format == ExportFormat::CSV) {
+        failed = !write_all("Word,Frequency,LastUsed\n");
+    } else if (options.format == ExportFormat::Columnar) {
+        failed = !write_all("RDXSTAT1");
+    }
+
+    for (size_t i = 0; i < options.threads; ++i) {
+        workers.emplace_back(&StatsExporter::worker, this);
+    }
+
+    std::vector<Row> rows;
+    rows.reserve(options.chunk_rows);
+    auto add = [&](const std::string& word, const WordInfo& info) {
+        rows.push_back({word, info});
+        ++stats.rows;
+        if (rows.size() == options.chunk_rows) {
+            submit(std::move(rows));
+            rows = std::vector<Row>();
+            rows.reserve(options.chunk_rows);
+        }
+        return !failed;
+    };
+    if (options.order == ExportOrder::Frequency) {
+        dict.forEachByFrequency(add);
+    } else {
+        auto it = dict.iterator();
+        for (it.seek(""); it.valid() && add(it.key(), WordInfo()); it.next()) {
+        }
+    }
+    if (!rows.empty()) {
+        submit(std::move(rows));
+    }
+    drain(true);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+    workers.clear();
+
+    if (!failed && options.format == ExportFormat::Columnar) {
+        std::string end;
+        append_raw(end, static_cast<uint32_t>(0));
+        failed = !write_all(end);
+    }
+    if (!failed && fsync(fd) != 0) {
+        failed = true;
+    }
+    ::close(fd);
+    fd = -1;
+    if (failed || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (result) {
+        *result = stats;
+    }
+    return true;
+}
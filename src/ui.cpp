@@ -23,7 +23,8 @@ UI::UI() : input_buffer("") {
     getmaxyx(stdscr, max_y, max_x);
     
     // Create windows
-    main_win = newwin(max_y - 2, max_x, 0, 0);
+    main_win = newwin(max_y - 3, max_x, 0, 0);
+    hint_win = newwin(2, max_x - 4, max_y - 3, 2);
     input_win = newwin(1, max_x - 10, max_y - 1, 2);
     
     // Enable keypad for special keys
@@ -45,7 +46,12 @@ UI::UI() : input_buffer("") {
 }
 
 UI::~UI() {
+    stop_lookups();
+    if (browse_saved) {
+        delwin(browse_saved);
+    }
     delwin(main_win);
+    delwin(hint_win);
     delwin(input_win);
     endwin();
 }
@@ -100,15 +106,24 @@ void UI::draw_footer(const std::string& status) {
 }
 
 void UI::process_input(int ch) {
+    if (browse) {
+        browse_key(ch);
+        return;
+    }
     switch (ch) {
         case KEY_BACKSPACE:
         case 127:  // Backspace
         case 8:    // Backspace (alternative)
             if (!input_buffer.empty()) {
                 input_buffer.pop_back();
-                wclear(input_win);
-                wprintw(input_win, "%s", input_buffer.c_str());
-                wrefresh(input_win);
+                input_changed();
+            }
+            break;
+
+        case '\t':  // Accept the first completion
+            if (!completions.empty() && completions[0] != input_buffer) {
+                input_buffer = completions[0];
+                input_changed();
             }
             break;
             
@@ -118,8 +133,7 @@ void UI::process_input(int ch) {
                 // Process command
                 std::string cmd = input_buffer;
                 input_buffer.clear();
-                wclear(input_win);
-                wrefresh(input_win);
+                input_changed();
                 
                 // Add to history
                 search_history.push_back(cmd);
@@ -135,15 +149,18 @@ void UI::process_input(int ch) {
                     wprintw(main_win, "  /h       - Show history\n");
                     wprintw(main_win, "  /c       - Clear screen\n");
                     wprintw(main_win, "  /a or /add - Add a new word (interactive)\n");
+                    wprintw(main_win, "  /d terms - Find words whose meaning contains terms\n");
+                    wprintw(main_win, "  /p [prefix] - Browse words starting with prefix\n");
+                    wprintw(main_win, "  /metrics - Show operation latencies and cache counters\n");
                     wprintw(main_win, "  word     - Search for a word\n\n");
                     wprintw(main_win, "Keyboard Shortcuts:\n");
+                    wprintw(main_win, "  Tab      - Complete to the first suggestion\n");
                     wprintw(main_win, "  F1       - Show this help\n");
                     wprintw(main_win, "  Ctrl+L   - Clear screen\n");
                     wprintw(main_win, "  Esc      - Exit\n\n");
                 } else if (cmd == "/q") {
                     // Quit
-                    endwin();
-                    exit(0);
+                    quit();
                 } else if (cmd == "/c") {
                     // Clear screen
                     wclear(main_win);
@@ -166,22 +183,34 @@ void UI::process_input(int ch) {
                     wclear(main_win);
                     draw_header();
                     wrefresh(main_win);
-                } else {
-                    // Search for word
-                    wprintw(main_win, "\n> %s\n", cmd.c_str());
-                    auto results = on_search(cmd);
+                } else if (cmd.rfind("/d ", 0) == 0) {
+                    // Reverse lookup by meaning
+                    std::string query = cmd.substr(3);
+                    wprintw(main_win, "\n> meanings matching: %s\n", query.c_str());
+                    auto results = on_search_definitions(query);
                     
                     if (results.empty()) {
-                        wprintw(main_win, "  No results found.\n");
+                        wprintw(main_win, "  No matching meanings.\n");
                     } else {
                         for (const auto& line : results) {
                             wprintw(main_win, "  %s\n", line.c_str());
                         }
                     }
+                } else if (cmd == "/metrics") {
+                    wprintw(main_win, "\n%s\n", on_metrics().c_str());
+                } else if (cmd == "/p" || cmd.rfind("/p ", 0) == 0) {
+                    open_browse(cmd.size() > 3 ? cmd.substr(3) : "");
+                } else {
+                    // Search for word; the result is printed when the
+                    // lookup thread posts it
+                    request_lookup(cmd, false);
+                    draw_hints("Looking up '" + cmd + "'...");
                 }
                 
-                wrefresh(main_win);
-                draw_footer("Type to search. Press F1 for help.");
+                if (!browse) {
+                    wrefresh(main_win);
+                }
+                draw_input();
             }
             break;
             
@@ -189,6 +218,7 @@ void UI::process_input(int ch) {
             // Show help
             wprintw(main_win, "\nKeyboard Shortcuts:\n");
             wprintw(main_win, "  F1       - Show this help\n");
+            wprintw(main_win, "  Tab      - Complete to the first suggestion\n");
             wprintw(main_win, "  Ctrl+L   - Clear screen\n");
             wprintw(main_win, "  Ctrl+U   - Clear input\n");
             wprintw(main_win, "  Up/Down  - Navigate history\n");
@@ -204,13 +234,12 @@ void UI::process_input(int ch) {
             
         case 21:  // Ctrl+U
             input_buffer.clear();
-            wclear(input_win);
-            wrefresh(input_win);
+            input_changed();
             break;
             
         case 27:  // ESC key
-            endwin();
-            exit(0);
+            quit();
+            break;
             
         case KEY_UP:
             // Navigate history (simplified)
@@ -219,9 +248,7 @@ void UI::process_input(int ch) {
                 if (hist_pos > 0) {
                     hist_pos--;
                     input_buffer = search_history[hist_pos];
-                    wclear(input_win);
-                    wprintw(input_win, "%s", input_buffer.c_str());
-                    wrefresh(input_win);
+                    input_changed();
                 }
             }
             break;
@@ -236,9 +263,7 @@ void UI::process_input(int ch) {
                 } else {
                     input_buffer.clear();
                 }
-                wclear(input_win);
-                wprintw(input_win, "%s", input_buffer.c_str());
-                wrefresh(input_win);
+                input_changed();
             }
             break;
             
@@ -246,13 +271,162 @@ void UI::process_input(int ch) {
             // Add character to input buffer
             if (isprint(ch)) {
                 input_buffer += ch;
-                wprintw(input_win, "%c", ch);
-                wrefresh(input_win);
+                input_changed();
             }
             break;
     }
 }
 
+void UI::input_changed() {
+    ++generation;
+    last_edit = std::chrono::steady_clock::now();
+    preview_requested = input_buffer.empty();
+    {
+        // Any preview still queued or running is for older input now
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        current_generation = generation;
+        has_preview = false;
+    }
+    completions = on_complete(input_buffer, MAX_COMPLETIONS);
+    draw_hints();
+}
+
+void UI::draw_input() {
+    werase(input_win);
+    wprintw(input_win, "%s", input_buffer.c_str());
+    wrefresh(input_win);
+}
+
+void UI::draw_hints(const std::string& preview_line) {
+    int width = getmaxx(hint_win);
+    werase(hint_win);
+    int x = 0;
+    for (size_t i = 0; i < completions.size(); ++i) {
+        const std::string& word = completions[i];
+        if (x + (int)word.size() > width) {
+            break;
+        }
+        if (i == 0) {
+            wattron(hint_win, COLOR_PAIR(1) | A_BOLD);
+        }
+        mvwprintw(hint_win, 0, x, "%s", word.c_str());
+        if (i == 0) {
+            wattroff(hint_win, COLOR_PAIR(1) | A_BOLD);
+        }
+        x += word.size() + 2;
+    }
+    if (!preview_line.empty()) {
+        wattron(hint_win, COLOR_PAIR(3));
+        mvwaddnstr(hint_win, 1, 0, preview_line.c_str(), width);
+        wattroff(hint_win, COLOR_PAIR(3));
+    }
+    wrefresh(hint_win);
+    draw_input();  // leaves the terminal cursor in the input line
+}
+
+void UI::request_lookup(const std::string& query, bool is_preview) {
+    {
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        if (is_preview) {
+            preview = {generation, query, true};
+            has_preview = true;
+        } else {
+            lookups.push_back({generation, query, false});
+        }
+    }
+    lookup_cv.notify_one();
+}
+
+void UI::lookup_loop() {
+    while (true) {
+        LookupRequest request;
+        {
+            std::unique_lock<std::mutex> lock(lookup_mutex);
+            lookup_cv.wait(lock, [&] { return lookup_stop || !lookups.empty() || has_preview; });
+            if (lookup_stop) {
+                return;
+            }
+            // Searches the user asked for go before previews
+            if (!lookups.empty()) {
+                request = std::move(lookups.front());
+                lookups.pop_front();
+            } else {
+                request = std::move(preview);
+                has_preview = false;
+            }
+        }
+
+        LookupResult result{request.generation, request.query, request.preview, {}};
+        if (request.preview) {
+            std::string line = on_preview(request.query);
+            if (!line.empty()) {
+                result.lines.push_back(request.query + ": " + line);
+            }
+        } else {
+            result.lines = on_search(request.query);
+        }
+
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        if (request.preview && request.generation != current_generation) {
+            continue;  // the user kept typing; nobody wants this preview
+        }
+        lookup_results.push_back(std::move(result));
+    }
+}
+
+void UI::show_lookup_results() {
+    if (browse) {
+        return;  // printed once the pane is closed
+    }
+    std::deque<LookupResult> ready;
+    {
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        ready.swap(lookup_results);
+    }
+    if (ready.empty()) {
+        return;
+    }
+    bool printed = false;
+    std::string preview_line;
+    for (const auto& result : ready) {
+        if (result.preview) {
+            if (result.generation == generation && !result.lines.empty()) {
+                preview_line = result.lines[0];
+            }
+            continue;
+        }
+        wprintw(main_win, "\n> %s\n", result.query.c_str());
+        if (result.lines.empty()) {
+            wprintw(main_win, "  No results found.\n");
+        } else {
+            for (const auto& line : result.lines) {
+                wprintw(main_win, "  %s\n", line.c_str());
+            }
+        }
+        printed = true;
+    }
+    if (printed) {
+        wrefresh(main_win);
+    }
+    draw_hints(preview_line);
+}
+
+void UI::stop_lookups() {
+    if (!lookup_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        lookup_stop = true;
+    }
+    lookup_cv.notify_one();
+    lookup_thread.join();
+}
+
+void UI::quit() {
+    running = false;
+}
+
 void UI::run() {
     // Show word of the day after initialization
     std::string wod = get_word_of_the_day();
@@ -265,9 +439,135 @@ void UI::run() {
         wrefresh(main_win);
     }
     
-    // Main input loop
-    int ch;
-    while ((ch = wgetch(input_win)) != 'q') {
-        process_input(ch);
+    // Main input loop. wgetch times out every POLL_MS so finished lookups
+    // and the preview debounce are handled while the user is idle.
+    lookup_thread = std::thread(&UI::lookup_loop, this);
+    wtimeout(input_win, POLL_MS);
+    while (running) {
+        int ch = wgetch(input_win);
+        if (ch != ERR) {
+            process_input(ch);
+        }
+        show_lookup_results();
+        if (!preview_requested && !completions.empty() &&
+            std::chrono::steady_clock::now() - last_edit >= std::chrono::milliseconds(DEBOUNCE_MS)) {
+            preview_requested = true;
+            request_lookup(completions[0], true);
+        }
     }
+
+    // The lookup thread calls back into the subclass; stop it before the
+    // app tears anything down
+    stop_lookups();
+    on_quit();
+}
+
+void UI::open_browse(const std::string& prefix) {
+    browse = on_browse(prefix);
+    if (!browse) {
+        wprintw(main_win, "\n  Browsing is not available.\n");
+        return;
+    }
+    browse_prefix = prefix;
+    browse_saved = dupwin(main_win);
+    int height = getmaxy(main_win);
+    werase(main_win);
+    wattron(main_win, COLOR_PAIR(3) | A_BOLD);
+    mvwaddnstr(main_win, 0, 0,
+               ("Words starting with '" + prefix + "'  PgUp/PgDn Up/Down Home/End, letter jumps, Esc closes").c_str(),
+               getmaxx(main_win) - 1);
+    wattroff(main_win, COLOR_PAIR(3) | A_BOLD);
+    wsetscrreg(main_win, 1, height - 1);
+    browse_rows.clear();
+    browse_lines.assign(height, "");
+    show_rows(browse->rows_from(prefix, height - 1));
+}
+
+void UI::close_browse() {
+    browse.reset();
+    wsetscrreg(main_win, 0, getmaxy(main_win) - 1);
+    overwrite(browse_saved, main_win);
+    delwin(browse_saved);
+    browse_saved = nullptr;
+    touchwin(main_win);
+    wrefresh(main_win);
+    draw_hints();
+}
+
+void UI::browse_key(int ch) {
+    size_t page = getmaxy(main_win) - 1;
+    const std::string top = browse_rows.empty() ? browse_prefix : browse_rows[0];
+    switch (ch) {
+        case KEY_NPAGE:
+        case KEY_DOWN: {
+            // Read past the current page so the last page stays full
+            size_t step = ch == KEY_NPAGE ? page : 1;
+            auto rows = browse->rows_from(top, page + step);
+            if (rows.size() > page) {
+                size_t first = std::min(step, rows.size() - page);
+                show_rows(std::vector<std::string>(rows.begin() + first, rows.begin() + first + page));
+            }
+            break;
+        }
+        case KEY_PPAGE:
+        case KEY_UP: {
+            auto before = browse->rows_before(top, ch == KEY_PPAGE ? page : 1);
+            if (!before.empty()) {
+                show_rows(browse->rows_from(before[0], page));
+            }
+            break;
+        }
+        case KEY_HOME:
+            show_rows(browse->rows_from(browse_prefix, page));
+            break;
+        case KEY_END:
+            show_rows(browse->last_rows(page));
+            break;
+        case 27:  // Esc
+        case '\n':
+        case '\r':
+            close_browse();
+            break;
+        default:
+            if (ch >= 0 && ch < 256 && isalnum(ch)) {
+                // Jump to the first word continuing the prefix with this
+                // character, keeping a full page when that is near the end
+                auto rows = browse->rows_from(browse_prefix + (char)ch, page);
+                if (rows.size() < page) {
+                    rows = browse->last_rows(page);
+                }
+                show_rows(std::move(rows));
+            }
+            break;
+    }
+}
+
+void UI::show_rows(std::vector<std::string> rows) {
+    int height = getmaxy(main_win);
+    int width = getmaxx(main_win);
+    // A one-row step scrolls the window so only the new row is drawn
+    if (rows.size() > 1 && rows.size() == browse_rows.size()) {
+        if (rows[0] == browse_rows[1]) {
+            wscrl(main_win, 1);
+            browse_lines.erase(browse_lines.begin() + 1);
+            browse_lines.push_back("");
+        } else if (rows[1] == browse_rows[0]) {
+            wscrl(main_win, -1);
+            browse_lines.insert(browse_lines.begin() + 1, "");
+            browse_lines.pop_back();
+        }
+    }
+    for (int y = 1; y < height; ++y) {
+        const std::string line = (size_t)(y - 1) < rows.size() ? "  " + rows[y - 1] : "";
+        if (browse_lines[y] == line) {
+            continue;
+        }
+        wmove(main_win, y, 0);
+        wclrtoeol(main_win);
+        waddnstr(main_win, line.c_str(), width - 1);
+        browse_lines[y] = line;
+    }
+    browse_rows = std::move(rows);
+    wrefresh(main_win);
+    draw_input();
 }
@@ -1,63 +1,142 @@
 #include "../include/user_manager.hpp"
+#include <iostream>
 #include <stdexcept>
 
-UserManager::UserManager() : usersFile("users/.users") {
+UserManager::UserManager() : usersDb("users/users.db"), legacyFile("users/.users") {
     std::filesystem::create_directories("users");
-    loadUsers();
+    if (openStore()) {
+        migrateLegacyFile();
+    }
+}
+
+UserManager::~UserManager() {
+    sqlite3_finalize(findStmt);
+    sqlite3_finalize(insertStmt);
+    sqlite3_finalize(deleteStmt);
+    sqlite3_close(db);
 }
 
-void UserManager::loadUsers() {
-    std::ifstream file(usersFile);
+bool UserManager::openStore() {
+    if (sqlite3_open(usersDb.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Error opening user store: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+    // Other processes may be signing up at the same time; wait for their
+    // write lock instead of failing with SQLITE_BUSY
+    sqlite3_busy_timeout(db, 5000);
+
+    const char* schema =
+        "PRAGMA journal_mode=WAL;"
+        "PRAGMA synchronous=NORMAL;"
+        "CREATE TABLE IF NOT EXISTS users ("
+        "  username TEXT PRIMARY KEY,"
+        "  password_hash TEXT NOT NULL,"
+        "  created_at INTEGER NOT NULL DEFAULT (strftime('%s','now'))"
+        ") WITHOUT ROWID;";
+    char* err_msg = nullptr;
+    if (sqlite3_exec(db, schema, nullptr, nullptr, &err_msg) != SQLITE_OK) {
+        std::cerr << "Failed to create user table: " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+        return false;
+    }
+
+    if (sqlite3_prepare_v2(db, "SELECT password_hash FROM users WHERE username = ?", -1, &findStmt,
+                           nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "INSERT INTO users (username, password_hash) VALUES (?, ?) "
+                               "ON CONFLICT(username) DO NOTHING",
+                           -1, &insertStmt, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "DELETE FROM users WHERE username = ?", -1, &deleteStmt, nullptr) !=
+            SQLITE_OK) {
+        std::cerr << "Failed to prepare user statements: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void UserManager::migrateLegacyFile() {
+    std::ifstream file(legacyFile);
     if (!file) return;
 
+    // One transaction for the whole file; rows already present (from an
+    // earlier or concurrent migration) are left alone
+    sqlite3_exec(db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
+    size_t imported = 0;
     std::string line;
     while (std::getline(file, line)) {
         size_t pos = line.find(':');
-        if (pos != std::string::npos) {
-            std::string username = line.substr(0, pos);
-            std::string password = line.substr(pos + 1);
-            users[username] = password;
+        if (pos == std::string::npos) continue;
+        std::string username = line.substr(0, pos);
+        std::string password = line.substr(pos + 1);
+        sqlite3_bind_text(insertStmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt, 2, password.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(insertStmt) == SQLITE_DONE) {
+            imported += sqlite3_changes(db);
         }
+        sqlite3_reset(insertStmt);
     }
-}
+    if (sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to migrate " << legacyFile << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return;
+    }
+    file.close();
 
-void UserManager::saveUsers() {
-    std::ofstream file(usersFile);
-    if (!file) return;
+    std::error_code ec;
+    std::filesystem::rename(legacyFile, legacyFile + ".migrated", ec);
+    if (imported > 0) {
+        std::cerr << "Migrated " << imported << " accounts from " << legacyFile << std::endl;
+    }
+}
 
-    for (const auto& [username, password] : users) {
-        file << username << ":" << password << "\n";
+bool UserManager::findUser(const std::string& username, std::string& hash) const {
+    if (!findStmt) return false;
+    sqlite3_bind_text(findStmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+    bool found = false;
+    if (sqlite3_step(findStmt) == SQLITE_ROW) {
+        hash = reinterpret_cast<const char*>(sqlite3_column_text(findStmt, 0));
+        found = true;
     }
+    sqlite3_reset(findStmt);
+    return found;
 }
 
 bool UserManager::createUser(const std::string& username, const std::string& password) {
-    if (users.find(username) != users.end()) {
-        return false; // User already exists
-    }
+    if (!insertStmt) return false;
 
     std::string hashedPassword = hashPassword(password);
-    users[username] = hashedPassword;
-    saveUsers();
+    sqlite3_bind_text(insertStmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insertStmt, 2, hashedPassword.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(insertStmt);
+    sqlite3_reset(insertStmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Failed to create user: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    if (sqlite3_changes(db) == 0) {
+        return false; // User already exists
+    }
 
     // Create user directory
     userDir = "users/" + username + "/";
     std::filesystem::create_directories(userDir);
-    
+
     // Create necessary files
     std::ofstream(userDir + "bookmarks.txt");
     std::ofstream(userDir + "stats.txt");
-    
+
     return true;
 }
 
 bool UserManager::authenticate(const std::string& username, const std::string& password) {
-    auto it = users.find(username);
-    if (it == users.end()) {
+    std::string storedHash;
+    if (!findUser(username, storedHash)) {
         return false; // User not found
     }
 
     std::string hashedPassword = hashPassword(password);
-    if (it->second == hashedPassword) {
+    if (storedHash == hashedPassword) {
         currentUser = username;
         userDir = "users/" + username + "/";
         return true;
@@ -66,8 +145,11 @@ bool UserManager::authenticate(const std::string& username, const std::string& p
 }
 
 bool UserManager::removeUser(const std::string& username) {
-    if (users.erase(username) > 0) {
-        saveUsers();
+    if (!deleteStmt) return false;
+    sqlite3_bind_text(deleteStmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(deleteStmt);
+    sqlite3_reset(deleteStmt);
+    if (rc == SQLITE_DONE && sqlite3_changes(db) > 0) {
         // Remove user directory
         std::string dirToRemove = "users/" + username + "/";
         if (std::filesystem::exists(dirToRemove)) {
@@ -101,5 +183,6 @@ std::string UserManager::getUserDir() const {
 }
 
 bool UserManager::userExists(const std::string& username) const {
-    return users.find(username) != users.end();
+    std::string hash;
+    return findUser(username, hash);
 }
@@ -0,0 +1,189 @@
+// Checks DictionaryDB's write paths: a bulk batch that names a word twice
+// (as real import files do) is committed with the word's last meaning and
+// found by full-text search, a bulk batch is not overwritten by meanings
+// queued before it, and queued writes whose commit fails are retried
+// rather than dropped, and counted when given up on. Run with `make test`;
+// exits non-zero on failure.
+#include "../include/database.hpp"
+#include "../include/definition_import.hpp"
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond "\n"; \
+            ++failures;                                                               \
+        }                                                                             \
+    } while (0)
+
+bool finds(DictionaryDB& db, const std::string& query, const std::string& word) {
+    for (const DefinitionMatch& m : db.search_definitions(query)) {
+        if (m.word == word) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void repeated_word_in_batch() {
+    DictionaryDB db(":memory:");
+    CHECK(db.add_words({{"apple", "A red fruit."}, {"apple", "A green fruit."}, {"pear", "A pale fruit."}}) == 3);
+    CHECK(db.get_meaning("apple") == "A green fruit.");
+    CHECK(db.get_meaning("pear") == "A pale fruit.");
+    CHECK(finds(db, "green", "apple"));
+    CHECK(!finds(db, "red", "apple"));
+    CHECK(finds(db, "pale", "pear"));
+
+    // Replacing an indexed meaning in a later batch still goes through FTS
+    CHECK(db.add_words({{"apple", "A crisp fruit."}, {"apple", "A sour fruit."}}) == 2);
+    CHECK(finds(db, "sour", "apple"));
+    CHECK(!finds(db, "green", "apple"));
+}
+
+void repeated_word_in_import() {
+    std::string path = (std::filesystem::temp_directory_path() / "database_test_import.csv").string();
+    {
+        std::ofstream out(path);
+        out << "word,meaning\n"
+            << "kiwi,A fuzzy fruit.\n"
+            << "lime,A sour citrus.\n"
+            << "kiwi,A flightless bird.\n";
+    }
+    DictionaryDB db(":memory:");
+    ImportResult result = import_definitions(db, path);
+    std::remove(path.c_str());
+    CHECK(result.ok);
+    CHECK(result.rows == 3);
+    CHECK(db.get_meaning("kiwi") == "A flightless bird.");
+    CHECK(finds(db, "bird", "kiwi"));
+    CHECK(!finds(db, "fuzzy", "kiwi"));
+    CHECK(finds(db, "citrus", "lime"));
+}
+
+// A second connection to `path` holding the write lock until release()
+class WriteLock {
+public:
+    sqlite3* handle = nullptr;
+
+    explicit WriteLock(const std::string& path) {
+        sqlite3_open(path.c_str(), &handle);
+        sqlite3_exec(handle, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr);
+    }
+    ~WriteLock() {
+        release();
+        sqlite3_close(handle);
+    }
+    void release() { sqlite3_exec(handle, "COMMIT;", nullptr, nullptr, nullptr); }
+
+    // First column of the first row of `sql`, or "" if none
+    std::string query(const std::string& sql) {
+        std::string value;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(handle, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+            value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+        return value;
+    }
+};
+
+std::string fresh_db(const std::string& name) {
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    return path;
+}
+
+DictionaryDBOptions impatient_options() {
+    DictionaryDBOptions options;
+    options.busy_timeout_ms = 20;
+    options.flush_interval_ms = 50;
+    return options;
+}
+
+void failed_flush_is_retried() {
+    std::string path = fresh_db("database_test_retry.db");
+    {
+        DictionaryDB db(path, impatient_options());
+        WriteLock lock(path);
+        db.add_word("quince", "A hard yellow fruit.");
+        db.record_search("quince");
+        db.record_search("quince");
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));  // a few failed commits
+        CHECK(db.get_meaning("quince") == "A hard yellow fruit.");    // still queued
+
+        lock.release();
+        db.flush();
+        CHECK(lock.query("SELECT meaning FROM words WHERE word = 'quince';") == "A hard yellow fruit.");
+        CHECK(lock.query("SELECT search_count FROM search_counts WHERE word = 'quince';") == "2");
+        CHECK(db.lost_write_events() == 0);
+    }
+    fresh_db("database_test_retry.db");
+}
+
+void hopeless_flush_is_counted() {
+    std::string path = fresh_db("database_test_lost.db");
+    {
+        DictionaryDBOptions options = impatient_options();
+        options.write_retries = 1;
+        DictionaryDB db(path, options);
+        WriteLock lock(path);
+        db.add_word("sloe", "A small sour plum.");
+        db.record_search("sloe");
+        db.flush();  // returns once the batch is given up on
+        CHECK(db.lost_write_events() == 2);
+    }
+    fresh_db("database_test_lost.db");
+}
+
+void import_beats_queued_word() {
+    std::string path = fresh_db("database_test_queue.db");
+    {
+        DictionaryDBOptions options;
+        options.flush_interval_ms = 60000;  // keep add_word queued
+        DictionaryDB db(path, options);
+        db.add_word("plum", "An old meaning.");
+        db.add_word("damson", "A queued meaning.");
+        CHECK(db.add_words({{"plum", "A purple fruit."}}) == 1);
+        CHECK(db.get_meaning("plum") == "A purple fruit.");
+        db.flush();
+
+        WriteLock reader(path);
+        reader.release();  // only here to read what reached the file
+        CHECK(reader.query("SELECT meaning FROM words WHERE word = 'plum';") == "A purple fruit.");
+        CHECK(reader.query("SELECT meaning FROM words WHERE word = 'damson';") == "A queued meaning.");
+        CHECK(finds(db, "purple", "plum"));
+    }
+    fresh_db("database_test_queue.db");
+}
+
+} // namespace
+
+int main() {
+    repeated_word_in_batch();
+    repeated_word_in_import();
+    import_beats_queued_word();
+    failed_flush_is_retried();
+    hopeless_flush_is_counted();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "database_test: all checks passed" << std::endl;
+    return 0;
+}
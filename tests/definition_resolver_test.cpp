@@ -0,0 +1,239 @@
+// Checks the single-flight behaviour of DefinitionResolver against a
+// counting stand-in for the dictionary API: a burst of concurrent misses
+// for one word costs one fetch, errors are handed to the burst but neither
+// stored nor kept past the failure window, a fetch that throws does not
+// wedge the word, and a lookup made while the prefetcher holds the word's
+// lease waits for that fetch. Run with `make test`; exits non-zero on
+// failure.
+#include "../include/database.hpp"
+#include "../include/definition_fetcher.hpp"
+#include "../include/definition_resolver.hpp"
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond "\n"; \
+            ++failures;                                                               \
+        }                                                                             \
+    } while (0)
+
+// Counts fetches and answers each after `delay`, so concurrent callers
+// overlap with the one that is fetching
+class CountingFetcher : public DefinitionFetcher {
+public:
+    enum class Mode { Ok, NotFound, Error, Throw };
+
+    std::atomic<int> fetches{0};
+    std::atomic<Mode> mode{Mode::Ok};
+    std::chrono::milliseconds delay;
+
+    explicit CountingFetcher(std::chrono::milliseconds delay)
+        : DefinitionFetcher("http://127.0.0.1/"), delay(delay) {}
+
+    FetchResult fetch(const std::string& word) override {
+        ++fetches;
+        std::this_thread::sleep_for(delay);
+        FetchResult result;
+        switch (mode.load()) {
+        case Mode::Ok:
+            result.status = FetchResult::Status::Ok;
+            result.senses.push_back({"noun", "Counted definition of " + word + ".", ""});
+            break;
+        case Mode::NotFound:
+            result.status = FetchResult::Status::NotFound;
+            break;
+        case Mode::Error:
+            result.status = FetchResult::Status::Error;
+            result.error = "upstream down";
+            break;
+        case Mode::Throw:
+            throw std::runtime_error("fetch blew up");
+        }
+        return result;
+    }
+};
+
+// Starts `count` threads that each call `fn` once, all released together
+void burst(size_t count, const std::function<void(size_t)>& fn) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool go = false;
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back([&, i] {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return go; });
+            }
+            fn(i);
+        });
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        go = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void concurrent_misses_fetch_once() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(200)};
+    DefinitionResolver resolver(db, fetcher);
+
+    std::vector<Resolution> results(1000);
+    burst(results.size(), [&](size_t i) { results[i] = resolver.resolve("serendipity"); });
+
+    CHECK(fetcher.fetches == 1);
+    for (const Resolution& r : results) {
+        CHECK(r.found());
+        CHECK(r.meaning == results[0].meaning);
+    }
+    CHECK(db.get_meaning("serendipity") == results[0].meaning);
+
+    // Stored now: later lookups never reach the API
+    CHECK(resolver.resolve("Serendipity ").source == Resolution::Source::Database);
+    CHECK(fetcher.fetches == 1);
+}
+
+void errors_are_shared_then_retried() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(100)};
+    fetcher.mode = CountingFetcher::Mode::Error;
+    DefinitionResolver resolver(db, fetcher, std::chrono::milliseconds(300));
+
+    std::vector<Resolution> results(200);
+    burst(results.size(), [&](size_t i) { results[i] = resolver.resolve("flaky"); });
+    CHECK(fetcher.fetches == 1);
+    for (const Resolution& r : results) {
+        CHECK(r.source == Resolution::Source::Error);
+        CHECK(r.error == "upstream down");
+    }
+    // An error is neither a definition nor a remembered miss
+    CHECK(db.get_meaning("flaky").empty());
+    CHECK(!db.known_missing("flaky"));
+
+    // Inside the window the failure is handed back without fetching
+    CHECK(resolver.resolve("flaky").source == Resolution::Source::Error);
+    CHECK(fetcher.fetches == 1);
+
+    // After it the next call goes upstream again, and can succeed
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    fetcher.mode = CountingFetcher::Mode::Ok;
+    CHECK(resolver.resolve("flaky").source == Resolution::Source::Fetched);
+    CHECK(fetcher.fetches == 2);
+}
+
+void not_found_is_remembered() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(50)};
+    fetcher.mode = CountingFetcher::Mode::NotFound;
+    DefinitionResolver resolver(db, fetcher);
+
+    burst(100, [&](size_t) { CHECK(resolver.resolve("qwzx").source == Resolution::Source::NotFound); });
+    CHECK(fetcher.fetches == 1);
+    CHECK(db.known_missing("qwzx"));
+    CHECK(resolver.resolve("qwzx").source == Resolution::Source::NotFound);
+    CHECK(fetcher.fetches == 1);
+}
+
+void throwing_fetch_releases_the_word() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(100)};
+    fetcher.mode = CountingFetcher::Mode::Throw;
+    DefinitionResolver resolver(db, fetcher);
+
+    std::atomic<int> thrown{0};
+    burst(50, [&](size_t) {
+        try {
+            resolver.resolve("boom");
+        } catch (const std::runtime_error&) {
+            ++thrown;
+        }
+    });
+    CHECK(thrown == 50);
+    CHECK(fetcher.fetches == 1);
+
+    fetcher.mode = CountingFetcher::Mode::Ok;
+    CHECK(resolver.resolve("boom").source == Resolution::Source::Fetched);
+    CHECK(fetcher.fetches == 2);
+}
+
+void stored_case_is_found() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(0)};
+    DefinitionResolver resolver(db, fetcher);
+    db.add_word("NASA", "A space agency.");
+    db.add_word("apple", "A fruit.");
+
+    CHECK(resolver.resolve("NASA").meaning == "A space agency.");
+    CHECK(resolver.resolve(" NASA ").source == Resolution::Source::Database);
+    CHECK(resolver.resolve("Apple").meaning == "A fruit.");
+    CHECK(fetcher.fetches == 0);
+}
+
+void leased_lookup_waits_for_the_lease() {
+    DictionaryDB db(":memory:");
+    CountingFetcher fetcher{std::chrono::milliseconds(0)};
+    DefinitionResolver resolver(db, fetcher);
+
+    // What the prefetcher does: claim the word, fetch it elsewhere, store
+    auto lease = resolver.lead("mango");
+    CHECK(lease != nullptr);
+    CHECK(resolver.lead("mango") == nullptr);
+    Resolution waited;
+    std::thread user([&] { waited = resolver.resolve(" Mango"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    FetchResult fetched;
+    fetched.status = FetchResult::Status::Ok;
+    fetched.senses.push_back({"noun", "A tropical fruit.", ""});
+    lease->complete(resolver.store("mango", fetched));
+    user.join();
+    CHECK(waited.source == Resolution::Source::Fetched);
+    CHECK(waited.meaning == db.get_meaning("mango"));
+    CHECK(fetcher.fetches == 0);
+    CHECK(resolver.flight_stats().followers == 1);
+
+    // A lease dropped without completing frees the word
+    resolver.lead("papaya").reset();
+    CHECK(resolver.lead("papaya") != nullptr);
+}
+
+} // namespace
+
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    concurrent_misses_fetch_once();
+    errors_are_shared_then_retried();
+    not_found_is_remembered();
+    throwing_fetch_releases_the_word();
+    stored_case_is_found();
+    leased_lookup_waits_for_the_lease();
+    curl_global_cleanup();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "definition_resolver_test: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Checks that a user's statistics survive LayeredDictionary's save/load
+// cycle across logins, however many base words they touched, and that a
+// file from before the overlay (every word, every login's reload counted)
+// is trimmed to the user's own usage once. Run with `make test`; exits
+// non-zero on failure.
+#include "../include/layered_dictionary.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond "\n"; \
+            ++failures;                                                               \
+        }                                                                             \
+    } while (0)
+
+const std::vector<std::string> WORDS = {"apple",  "banana", "cherry", "date",  "elder", "fig",
+                                        "grape",  "guava",  "kiwi",   "lemon", "lime",  "mango",
+                                        "melon",  "olive",  "peach",  "pear",  "plum"};
+
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::shared_ptr<const BaseDictionary> load_base() {
+    std::string path = temp_path("layered_dictionary_test_words.txt");
+    {
+        std::ofstream out(path);
+        for (const std::string& w : WORDS) {
+            out << w << "\n";
+        }
+    }
+    auto base = BaseDictionary::load(path);
+    std::remove(path.c_str());
+    return base;
+}
+
+size_t lines_in(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    size_t n = 0;
+    while (std::getline(in, line)) {
+        ++n;
+    }
+    return n;
+}
+
+void overlay_stats_survive_logins() {
+    auto base = load_base();
+    std::string stats = temp_path("layered_dictionary_test_stats.txt");
+    std::ofstream(stats).close();  // a new user's empty file
+
+    // Each login looks up more than half of the base words once
+    for (int login = 1; login <= 3; ++login) {
+        LayeredDictionary dict(base);
+        dict.loadStats(stats);
+        for (size_t i = 0; i < 9; ++i) {
+            dict.recordUsage(WORDS[i]);
+        }
+        dict.saveStats(stats);
+
+        LayeredDictionary reloaded(base);
+        reloaded.loadStats(stats);
+        for (size_t i = 0; i < WORDS.size(); ++i) {
+            int expected = 1 + (i < 9 ? login : 0);  // base count plus lookups
+            CHECK(reloaded.getWordInfo(WORDS[i]).frequency == expected);
+        }
+    }
+    CHECK(lines_in(stats) == 1 + 9);
+    std::remove(stats.c_str());
+}
+
+void legacy_stats_are_trimmed_once() {
+    auto base = load_base();
+    std::string stats = temp_path("layered_dictionary_test_legacy.txt");
+    {
+        // Two logins of the old per-user tree: every word reloaded twice,
+        // "kiwi" looked up three times, "zebra" added by the user
+        std::ofstream out(stats);
+        for (const std::string& w : WORDS) {
+            out << w << " " << (w == "kiwi" ? 5 : 2) << " 1700000000\n";
+        }
+        out << "zebra 1 1700000000\n";
+    }
+
+    LayeredDictionary dict(base);
+    dict.loadStats(stats);
+    CHECK(dict.getWordInfo("kiwi").frequency == 1 + 3);
+    CHECK(dict.getWordInfo("apple").frequency == 1);
+    CHECK(dict.getWordInfo("zebra").frequency == 1);
+    CHECK(lines_in(stats) == 1 + 2);
+
+    // The rewritten file is in the new format and loads unchanged
+    LayeredDictionary again(base);
+    again.loadStats(stats);
+    CHECK(again.getWordInfo("kiwi").frequency == 1 + 3);
+    CHECK(again.getWordInfo("zebra").frequency == 1);
+    CHECK(lines_in(stats) == 1 + 2);
+    std::remove(stats.c_str());
+}
+
+} // namespace
+
+int main() {
+    overlay_stats_survive_logins();
+    legacy_stats_are_trimmed_once();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "layered_dictionary_test: all checks passed" << std::endl;
+    return 0;
+}